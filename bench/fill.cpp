@@ -0,0 +1,142 @@
+#include "Fill.h"
+#include "Convert.h"
+
+#include <cstdint>
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+#include <fmt/format.h>
+
+using namespace Wayland;
+
+struct Size
+{
+	int width ;
+	int height;
+};
+
+// The column-major, byte-at-a-time loop the windows used to draw with
+static void legacy(uint32_t* data, int width, int height, int stride)
+{
+	char* shm_data = (char*)data;
+
+	for (int x = 0; x < width; x++)
+	{
+		for (int y = 0; y < height; y++)
+		{
+			int offset = x * 4 + y * stride;
+
+			shm_data[offset + 2] = (x / (float)width ) * 256;
+			shm_data[offset + 1] = (y / (float)height) * 256;
+			shm_data[offset + 0] = 0x00;
+			shm_data[offset + 3] = 0xFF;
+		}
+	}
+}
+
+template<typename F>
+static double time_ms(F&& f, int iterations)
+{
+	f(); // warm up, and fault the pages in
+
+	auto start = std::chrono::steady_clock::now();
+	for (int a = 0; a < iterations; a++)
+		f();
+	auto end = std::chrono::steady_clock::now();
+
+	return std::chrono::duration<double, std::milli>(end - start).count() / iterations;
+}
+
+int main()
+{
+	const Size sizes[] = { { 320, 200 }, { 1280, 720 }, { 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 } };
+	const Fill::Path paths[] = { Fill::Path::Scalar, Fill::Path::SSE2, Fill::Path::AVX2 };
+
+	std::cout << fmt::format("{:>10} {:>10} {:>8} {:>10} {:>10}\n", "size", "kernel", "path", "ms", "GB/s");
+
+	for (const Size& size : sizes)
+	{
+		int    stride     = size.width * 4;
+		size_t bytes      = (size_t)stride * size.height;
+		int    iterations = (int)(2000000000 / bytes) + 1;
+
+		std::vector<uint32_t> reference(bytes / 4);
+		std::vector<uint32_t> pixels   (bytes / 4);
+
+		auto report = [&](const char* kernel, const char* path, double ms)
+		{
+			std::cout << fmt::format("{:>10} {:>10} {:>8} {:>10.3f} {:>10.2f}\n", fmt::format("{}x{}", size.width, size.height), kernel, path, ms, bytes / ms / 1e6);
+		};
+
+		report("legacy", "-", time_ms([&] { legacy(pixels.data(), size.width, size.height, stride); }, iterations));
+
+		for (int kernel = 0; kernel < 4; kernel++)
+		{
+			static const char* names[] = { "solid", "horizontal", "vertical", "bilinear" };
+
+			auto run = [&](uint32_t* data)
+			{
+				switch (kernel)
+				{
+				case 0: Fill::Solid     (data, size.width, size.height, stride, 0xFF336699); break;
+				case 1: Fill::Horizontal(data, size.width, size.height, stride, 0xFF000000, 0xFFFF0000); break;
+				case 2: Fill::Vertical  (data, size.width, size.height, stride, 0xFF000000, 0xFF00FF00); break;
+				case 3: Fill::Bilinear  (data, size.width, size.height, stride, 0xFF000000, 0xFFFF0000, 0xFF00FF00, 0xFFFFFF00); break;
+				}
+			};
+
+			Fill::Select(Fill::Path::Scalar);
+			run(reference.data());
+
+			for (Fill::Path path : paths)
+			{
+				if (!Fill::Select(path))
+					continue;
+
+				double ms = time_ms([&] { run(pixels.data()); }, iterations);
+
+				if (pixels != reference)
+				{
+					std::cerr << fmt::format("{} {} does not match the scalar reference\n", names[kernel], Fill::Name(path));
+					return 1;
+				}
+
+				report(names[kernel], Fill::Name(path), ms);
+			}
+		}
+
+		for (int converter = 0; converter < 2; converter++)
+		{
+			static const char* names[] = { "rgb565", "xrgb2101010" };
+			static const uint32_t formats[] = { WL_SHM_FORMAT_RGB565, WL_SHM_FORMAT_XRGB2101010 };
+
+			uint32_t format             = formats[converter];
+			int      destination_stride = size.width * Convert::BytesPerPixel(format);
+
+			std::vector<char> expected (bytes);
+			std::vector<char> converted(bytes);
+
+			Fill::Select(Fill::Path::Scalar);
+			Fill::Bilinear(reference.data(), size.width, size.height, stride, 0xFF000000, 0xFFFF0000, 0xFF00FF00, 0xFFFFFF00);
+			Convert::Rows(reference.data(), stride, expected.data(), destination_stride, size.width, 0, size.height, format);
+
+			for (Fill::Path path : paths)
+			{
+				if (!Fill::Select(path))
+					continue;
+
+				double ms = time_ms([&] { Convert::Rows(reference.data(), stride, converted.data(), destination_stride, size.width, 0, size.height, format); }, iterations);
+
+				if (converted != expected)
+				{
+					std::cerr << fmt::format("{} {} does not match the scalar reference\n", names[converter], Fill::Name(path));
+					return 1;
+				}
+
+				report(names[converter], Fill::Name(path), ms);
+			}
+		}
+	}
+}
@@ -0,0 +1,269 @@
+#include "Wayland.h"
+#include "Fill.h"
+#include "Compositor.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+using namespace Wayland;
+
+struct Size
+{
+	int width ;
+	int height;
+};
+
+Headless::Compositor compositor;
+Window               window    ;
+
+wl_display* display = nullptr; // a second connection, for Swapchains outside any window
+wl_shm    * shm     = nullptr;
+
+namespace Bench
+{
+	namespace Functions
+	{
+		namespace WL_Registry
+		{
+			void Global(void* data, wl_registry* registry, uint32_t name, const char* interface, uint32_t version)
+			{
+				if (strcmp(interface, wl_shm_interface.name) == 0)
+					shm = (wl_shm*)wl_registry_bind(registry, name, &wl_shm_interface, 1);
+			}
+
+			void Global_Remove(void* data, wl_registry* registry, uint32_t name) {}
+		}
+	}
+
+	namespace Listeners
+	{
+		wl_registry_listener wl_registry
+		{
+			.global        = Functions::WL_Registry::Global,
+			.global_remove = Functions::WL_Registry::Global_Remove
+		};
+	}
+}
+
+static double elapsed_ms(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename F>
+static double time_ms(F&& f, int iterations)
+{
+	f(); // warm up, and fault the pages in
+
+	auto start = std::chrono::steady_clock::now();
+	for (int a = 0; a < iterations; a++)
+		f();
+
+	return elapsed_ms(start) / iterations;
+}
+
+// Polls until the compositor has seen the window commit another frame
+static void next_frame()
+{
+	uint64_t commits = compositor.GetStats().commits;
+
+	while (window.IsOpen() && compositor.GetStats().commits == commits)
+		window.Poll(1);
+}
+
+// An interactive resize, finished once the frame at the new size is committed
+static void resize(const Size& size)
+{
+	compositor.Configure(size.width, size.height, { XDG_TOPLEVEL_STATE_ACTIVATED, XDG_TOPLEVEL_STATE_RESIZING });
+	next_frame();
+}
+
+// Frames per second and mean commit to release latency over frames redraws
+static void frames(int count, double& fps, double& latency_ms)
+{
+	Headless::Compositor::Stats before = compositor.GetStats();
+	auto                        start  = std::chrono::steady_clock::now();
+
+	for (int a = 0; a < count; a++)
+	{
+		window.Redraw();
+		next_frame();
+	}
+
+	double                      ms    = elapsed_ms(start);
+	Headless::Compositor::Stats after = compositor.GetStats();
+	uint64_t                    count_released = after.releases - before.releases;
+
+	fps        = count / ms * 1000;
+	latency_ms = count_released ? (after.release_latency_total - before.release_latency_total) / 1e6 / count_released : 0;
+}
+
+// Like time_ms, but waits for the compositor to catch up between
+// iterations, so requests never pile up in the socket
+template<typename F>
+static double time_requests_ms(F&& f, int iterations)
+{
+	double total = 0;
+
+	for (int a = 0; a <= iterations; a++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		f();
+		wl_display_flush(display);
+
+		if (a > 0) // the first one warms up
+			total += elapsed_ms(start);
+
+		wl_display_roundtrip(display);
+	}
+
+	return total / iterations;
+}
+
+// A fresh pool and buffer at size, the cost a window pays for its first frame
+static double create_buffer_ms(const Size& size, int iterations)
+{
+	return time_requests_ms([&]
+	{
+		Swapchain swapchain;
+		swapchain.Init(shm);
+		swapchain.Resize(size.width, size.height);
+		swapchain.Acquire();
+		swapchain.Destroy();
+	}, iterations);
+}
+
+// A buffer recreated in a pool that is already big enough, the cost of a resize
+static double recreate_buffer_ms(const Size& size, int iterations)
+{
+	Swapchain swapchain;
+	swapchain.Init(shm);
+
+	int    flip   = 0;
+	double result = time_requests_ms([&]
+	{
+		swapchain.Resize(size.width, size.height - (flip ^= 1));
+		swapchain.Acquire();
+	}, iterations);
+
+	swapchain.Destroy();
+	wl_display_flush(display);
+
+	return result;
+}
+
+// Writes to the file given as the first argument, build/bench.json by
+// default; stdout is left to the window's own logging.
+int main(int argc, char** argv)
+{
+	const char* path = argc > 1 ? argv[1] : "build/bench.json";
+
+	const Size sizes[] = { { 320, 200 }, { 1280, 720 }, { 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 } };
+
+	// Unthrottled, so the numbers are what the client costs and not the refresh rate
+	compositor.Start(0);
+
+	Window::SetupStatics();
+	window.Init(sizes[0].width, sizes[0].height, 0, 0);
+	next_frame();
+
+	display = wl_display_connect(nullptr);
+	if (display == nullptr)
+		throw std::runtime_error("Could not connect to the headless compositor");
+
+	wl_registry* registry = wl_display_get_registry(display);
+	wl_registry_add_listener(registry, &Bench::Listeners::wl_registry, nullptr);
+	wl_display_roundtrip(display);
+
+	Workers workers;
+	workers.Init();
+
+	std::string json = fmt::format("{{\n\t\"fill_path\": \"{}\",\n\t\"threads\": {},\n\t\"sizes\": [\n", Fill::Name(Fill::Selected()), workers.Count());
+
+	for (const Size& size : sizes)
+	{
+		std::cerr << fmt::format("bench: {}x{}\n", size.width, size.height);
+
+		size_t pixels     = (size_t)size.width * size.height;
+		int    iterations = (int)(50000000 / pixels) + 1;
+		int    count      = (int)(500000000 / pixels) + 10;
+
+		std::vector<uint32_t> canvas(pixels);
+
+		auto fill = [&](int first, int last)
+		{
+			Fill::Bilinear(canvas.data(), size.width, size.height, size.width * 4, 0xFF000000, 0xFFFF0000, 0xFF00FF00, 0xFFFFFF00, first, last);
+		};
+
+		double create   = create_buffer_ms  (size, iterations);
+		double recreate = recreate_buffer_ms(size, iterations);
+		double fill_1   = time_ms([&] { fill(0, size.height); }, iterations);
+		double fill_n   = time_ms([&] { workers.Run(size.height, fill); }, iterations);
+
+		resize(size);
+
+		double fps, latency;
+		frames(count, fps, latency);
+
+		json += fmt::format(
+			"\t\t{{ \"width\": {}, \"height\": {}, \"create_buffer_ms\": {:.4f}, \"recreate_buffer_ms\": {:.4f}, \"fill_ms\": {:.4f}, \"fill_threads_ms\": {:.4f}, \"frames\": {}, \"fps\": {:.1f}, \"commit_release_ms\": {:.4f} }}{}\n",
+			size.width, size.height, create, recreate, fill_1, fill_n, count, fps, latency, &size == &sizes[std::size(sizes) - 1] ? "" : ",");
+	}
+
+	json += "\t],\n";
+
+	// The same frames paced by a 60Hz refresh, where latency is mostly waiting for the vblank
+	{
+		std::cerr << "bench: paced\n";
+
+		const Size size = { 1920, 1080 };
+		compositor.SetRefresh(60000);
+		resize(size);
+
+		double fps, latency;
+		frames(120, fps, latency);
+
+		json += fmt::format("\t\"paced\": {{ \"refresh_mhz\": 60000, \"width\": {}, \"height\": {}, \"frames\": 120, \"fps\": {:.1f}, \"commit_release_ms\": {:.4f} }},\n", size.width, size.height, fps, latency);
+
+		compositor.SetRefresh(0);
+	}
+
+	// Every configure lands on a new size, so each one recreates the buffers
+	{
+		std::cerr << "bench: resize storm\n";
+
+		const int resizes = 200;
+		uint32_t  seed    = 1;
+
+		auto start = std::chrono::steady_clock::now();
+		for (int a = 0; a < resizes; a++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			resize(Size{ 320 + (int)(seed >> 8) % 1600, 200 + (int)(seed >> 20) % 880 });
+		}
+		double ms = elapsed_ms(start);
+
+		json += fmt::format("\t\"resize_storm\": {{ \"resizes\": {}, \"total_ms\": {:.3f}, \"per_resize_ms\": {:.4f} }}\n", resizes, ms, ms / resizes);
+	}
+
+	json += "}\n";
+
+	std::ofstream(path) << json;
+	std::cerr << fmt::format("bench: written to {}\n", path);
+
+	wl_shm_destroy(shm);
+	wl_registry_destroy(registry);
+	wl_display_disconnect(display);
+
+	compositor.Stop();
+}
@@ -1,10 +1,13 @@
 #include "Wayland.h"
+#include "Log.h"
 
 #include <cstring>
 #include <cstdint>
 
+#include <algorithm>
+#include <iterator>
 #include <stdexcept>
-#include <iostream>
+#include <string_view>
 #include <vector>
 
 #include <fmt/format.h>
@@ -32,27 +35,161 @@ namespace Wayland
 	EGLDisplay                  display_egl;
    	EGLConfig                   config_egl;
 
+	// Names for logging. Constant tables, so dispatching an event never
+	// allocates to describe it.
+	namespace Names
+	{
+		struct ShmFormatName
+		{
+			uint32_t         format;
+			std::string_view name  ;
+		};
+
+		#define Format(name) ShmFormatName{ WL_SHM_FORMAT_##name, "WL_SHM_FORMAT_" #name }
+
+		constexpr ShmFormatName shm_formats[] = {
+			Format(ARGB8888),
+			Format(XRGB8888),
+			Format(C8),
+			Format(RGB332),
+			Format(BGR233),
+			Format(XRGB4444),
+			Format(XBGR4444),
+			Format(RGBX4444),
+			Format(BGRX4444),
+			Format(ARGB4444),
+			Format(ABGR4444),
+			Format(RGBA4444),
+			Format(BGRA4444),
+			Format(XRGB1555),
+			Format(XBGR1555),
+			Format(RGBX5551),
+			Format(BGRX5551),
+			Format(ARGB1555),
+			Format(ABGR1555),
+			Format(RGBA5551),
+			Format(BGRA5551),
+			Format(RGB565),
+			Format(BGR565),
+			Format(RGB888),
+			Format(BGR888),
+			Format(XBGR8888),
+			Format(RGBX8888),
+			Format(BGRX8888),
+			Format(ABGR8888),
+			Format(RGBA8888),
+			Format(BGRA8888),
+			Format(XRGB2101010),
+			Format(XBGR2101010),
+			Format(RGBX1010102),
+			Format(BGRX1010102),
+			Format(ARGB2101010),
+			Format(ABGR2101010),
+			Format(RGBA1010102),
+			Format(BGRA1010102),
+			Format(YUYV),
+			Format(YVYU),
+			Format(UYVY),
+			Format(VYUY),
+			Format(AYUV),
+			Format(NV12),
+			Format(NV21),
+			Format(NV16),
+			Format(NV61),
+			Format(YUV410),
+			Format(YVU410),
+			Format(YUV411),
+			Format(YVU411),
+			Format(YUV420),
+			Format(YVU420),
+			Format(YUV422),
+			Format(YVU422),
+			Format(YUV444),
+			Format(YVU444),
+		};
+
+		#undef Format
+
+		constexpr std::string_view toplevel_states[] = {
+			"",
+			"XDG_TOPLEVEL_STATE_MAXIMIZED",
+			"XDG_TOPLEVEL_STATE_FULLSCREEN",
+			"XDG_TOPLEVEL_STATE_RESIZING",
+			"XDG_TOPLEVEL_STATE_ACTIVATED",
+			"XDG_TOPLEVEL_STATE_TILED_LEFT",
+			"XDG_TOPLEVEL_STATE_TILED_RIGHT",
+			"XDG_TOPLEVEL_STATE_TILED_TOP",
+			"XDG_TOPLEVEL_STATE_TILED_BOTTOM",
+		};
+
+		constexpr std::string_view decoration_modes[] = {
+			"",
+			"ZXDG_TOPLEVEL_DECORATION_V1_MODE_CLIENT_SIDE",
+			"ZXDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE",
+		};
+
+		// Empty for values the table does not know
+		template<size_t N>
+		constexpr std::string_view Get(const std::string_view (&names)[N], uint32_t value)
+		{
+			return value < N ? names[value] : std::string_view();
+		}
+
+		constexpr std::string_view ShmFormat(uint32_t format)
+		{
+			for (const ShmFormatName& entry : shm_formats)
+				if (entry.format == format)
+					return entry.name;
+
+			return std::string_view();
+		}
+	}
+
 	namespace Functions
 	{
 		namespace WL_Registry
 		{
-			#define Bind(T, var)\
-				if (!strcmp(interface, #T)) \
-					var = (T*)wl_registry_bind(wl_registry, name, &T##_interface, version)
+			// Every global the client binds, sorted by name for a binary search.
+			// version is the newest one our listeners implement. A compositor
+			// advertising a newer one is bound at ours, so it never sends
+			// events we have no handler for.
+			struct Interface
+			{
+				std::string_view    name   ;
+				const wl_interface* type   ;
+				uint32_t            version;
+				void              (*bind  )(wl_registry*, uint32_t name, const wl_interface* type, uint32_t version);
+			};
+
+			#define Bind(T, var, version) \
+				Interface{ #T, &T##_interface, version, [](wl_registry* wl_registry, uint32_t name, const wl_interface* type, uint32_t bound) \
+				{ \
+					var = (T*)wl_registry_bind(wl_registry, name, type, bound); \
+				} }
+
+			constexpr Interface interfaces[] = {
+				Bind(wl_compositor             , compositor        , 4), // damage_buffer
+				Bind(wl_seat                   , seat              , 2), // name
+				Bind(wl_shell                  , shell             , 1),
+				Bind(wl_shm                    , shm               , 1),
+				Bind(xdg_wm_base               , wm_base           , 2),
+				Bind(zxdg_decoration_manager_v1, decoration_manager, 1),
+			};
+
+			#undef Bind
+
+			static_assert(std::is_sorted(std::begin(interfaces), std::end(interfaces), [](const Interface& a, const Interface& b) { return a.name < b.name; }), "Registry interfaces must be sorted by name");
 
 			void Global(void* data, wl_registry* wl_registry, uint32_t name, const char* interface, uint32_t version)
 			{
-				std::cout << fmt::format("{}: {} {}\n", name, interface, version);
-
-				Bind(wl_compositor             , compositor        );
-				Bind(wl_shell                  , shell             );
-				Bind(wl_seat                   , seat              );
-				Bind(wl_shm                    , shm               );
-				Bind(xdg_wm_base               , wm_base           );
-				Bind(zxdg_decoration_manager_v1, decoration_manager);
-			}
+				LOG(Debug, "{}: {} {}", name, interface, version);
 
-			#undef Bind
+				std::string_view key   = interface;
+				const Interface* entry = std::lower_bound(std::begin(interfaces), std::end(interfaces), key, [](const Interface& entry, std::string_view key) { return entry.name < key; });
+
+				if (entry != std::end(interfaces) && entry->name == key)
+					entry->bind(wl_registry, name, entry->type, std::min(version, entry->version));
+			}
 
 			void Global_Remove(void* data, wl_registry* wl_registry, uint32_t name)
 			{
@@ -111,30 +248,15 @@ namespace Wayland
 			{
 				Window* window = (Window*)data;
 
-				std::vector<std::string> state_strings = {
-					"",
-					"XDG_TOPLEVEL_STATE_MAXIMIZED",
-					"XDG_TOPLEVEL_STATE_FULLSCREEN",
-					"XDG_TOPLEVEL_STATE_RESIZING",
-					"XDG_TOPLEVEL_STATE_ACTIVATED",
-					"XDG_TOPLEVEL_STATE_TILED_LEFT",
-					"XDG_TOPLEVEL_STATE_TILED_RIGHT",
-					"XDG_TOPLEVEL_STATE_TILED_TOP",
-					"XDG_TOPLEVEL_STATE_TILED_BOTTOM"
-				};
-                
                 bool resizing = false;
 				
-				std::cout << fmt::format("Size: {},{}\n", width, height);
-				std::cout << fmt::format("State Changes: {}, {}\n", states->size, states->alloc);
+				LOG(Debug, "Size: {},{}", width, height);
+				LOG(Debug, "State Changes: {}, {}", states->size, states->alloc);
 				
 				const uint32_t *state;
 				WL_ARRAY_FOR_EACH(state, states, const uint32_t*)
 				{
-					std::string state_string = "";
-					if (*state < state_strings.size())
-						state_string = state_strings[*state];
-					std::cout << fmt::format("\t{}: {}\n", *state, state_string);
+					LOG(Debug, "\t{}: {}", *state, Names::Get(Names::toplevel_states, *state));
                     
                     if (*state == 3)
                         resizing = true;
@@ -169,9 +291,7 @@ namespace Wayland
 		{
 			void Configure(void* data, zxdg_toplevel_decoration_v1* zxdg_toplevel_decoration_v1, uint32_t mode)
 			{
-				std::vector<std::string> modes = {"","ZXDG_TOPLEVEL_DECORATION_V1_MODE_CLIENT_SIDE","ZXDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE"};
-				std::string mode_string = modes[mode];
-				std::cout << fmt::format("Mode: {}\n", mode_string);
+				LOG(Info, "Mode: {}", Names::Get(Names::decoration_modes, mode));
 			}
 		}
 
@@ -179,71 +299,11 @@ namespace Wayland
 		{
 			void Format(void* data, wl_shm* wl_shm, uint32_t format)
 			{
-				std::vector<std::string> formats = {
-					"WL_SHM_FORMAT_ARGB8888",
-					"WL_SHM_FORMAT_XRGB8888",
-					"WL_SHM_FORMAT_C8",
-					"WL_SHM_FORMAT_RGB332",
-					"WL_SHM_FORMAT_BGR233",
-					"WL_SHM_FORMAT_XRGB4444",
-					"WL_SHM_FORMAT_XBGR4444",
-					"WL_SHM_FORMAT_RGBX4444",
-					"WL_SHM_FORMAT_BGRX4444",
-					"WL_SHM_FORMAT_ARGB4444",
-					"WL_SHM_FORMAT_ABGR4444",
-					"WL_SHM_FORMAT_RGBA4444",
-					"WL_SHM_FORMAT_BGRA4444",
-					"WL_SHM_FORMAT_XRGB1555",
-					"WL_SHM_FORMAT_XBGR1555",
-					"WL_SHM_FORMAT_RGBX5551",
-					"WL_SHM_FORMAT_BGRX5551",
-					"WL_SHM_FORMAT_ARGB1555",
-					"WL_SHM_FORMAT_ABGR1555",
-					"WL_SHM_FORMAT_RGBA5551",
-					"WL_SHM_FORMAT_BGRA5551",
-					"WL_SHM_FORMAT_RGB565",
-					"WL_SHM_FORMAT_BGR565",
-					"WL_SHM_FORMAT_RGB888",
-					"WL_SHM_FORMAT_BGR888",
-					"WL_SHM_FORMAT_XBGR8888",
-					"WL_SHM_FORMAT_RGBX8888",
-					"WL_SHM_FORMAT_BGRX8888",
-					"WL_SHM_FORMAT_ABGR8888",
-					"WL_SHM_FORMAT_RGBA8888",
-					"WL_SHM_FORMAT_BGRA8888",
-					"WL_SHM_FORMAT_XRGB2101010",
-					"WL_SHM_FORMAT_XBGR2101010",
-					"WL_SHM_FORMAT_RGBX1010102",
-					"WL_SHM_FORMAT_BGRX1010102",
-					"WL_SHM_FORMAT_ARGB2101010",
-					"WL_SHM_FORMAT_ABGR2101010",
-					"WL_SHM_FORMAT_RGBA1010102",
-					"WL_SHM_FORMAT_BGRA1010102",
-					"WL_SHM_FORMAT_YUYV",
-					"WL_SHM_FORMAT_YVYU",
-					"WL_SHM_FORMAT_UYVY",
-					"WL_SHM_FORMAT_VYUY",
-					"WL_SHM_FORMAT_AYUV",
-					"WL_SHM_FORMAT_NV12",
-					"WL_SHM_FORMAT_NV21",
-					"WL_SHM_FORMAT_NV16",
-					"WL_SHM_FORMAT_NV61",
-					"WL_SHM_FORMAT_YUV410",
-					"WL_SHM_FORMAT_YVU410",
-					"WL_SHM_FORMAT_YUV411",
-					"WL_SHM_FORMAT_YVU411",
-					"WL_SHM_FORMAT_YUV420",
-					"WL_SHM_FORMAT_YVU420",
-					"WL_SHM_FORMAT_YUV422",
-					"WL_SHM_FORMAT_YVU422",
-					"WL_SHM_FORMAT_YUV444",
-					"WL_SHM_FORMAT_YVU444"
-				};
-
-				if (format < formats.size())
-					std::cout << fmt::format("Format Supported: {}\n", formats[format]);
+				std::string_view name = Names::ShmFormat(format);
+				if (!name.empty())
+					LOG(Debug, "Format Supported: {}", name);
 				else
-					std::cout << fmt::format("Unknown Format: {}\n", format);
+					LOG(Debug, "Unknown Format: {}", format);
 			}
 		}
 	}
@@ -337,7 +397,7 @@ namespace Wayland
 		if(!eglInitialize(display_egl, &majorVersion, &minorVersion))
 			std::runtime_error("Could not initalize EGL.");
 
-		std::cout << fmt::format("EGL Version: {}.{}\n", majorVersion, minorVersion);
+		LOG(Info, "EGL Version: {}.{}", majorVersion, minorVersion);
 
 		if ((eglGetConfigs(display_egl, NULL, 0, &numConfigs) != EGL_TRUE) || (numConfigs == 0))
 			std::runtime_error("No EGL configuations found.");
@@ -386,10 +446,7 @@ namespace Wayland
 		wl_surface_commit(surface_wl);
 		wl_display_roundtrip(display);
 
-		wl_region* region = wl_compositor_create_region(compositor);
-
-  		wl_region_add(region, 0, 0, width, height);
-  		wl_surface_set_opaque_region(surface_wl, region);
+		set_opaque_region();
 
 		window_egl = wl_egl_window_create(surface_wl, width, height);
    		if (window_egl == EGL_NO_SURFACE)
@@ -413,6 +470,15 @@ namespace Wayland
 		isOpen = true;
 	}
 
+	void Window::set_opaque_region()
+	{
+		// Latched by the next eglSwapBuffers commit
+		wl_region* region = wl_compositor_create_region(compositor);
+		wl_region_add(region, 0, 0, width, height);
+		wl_surface_set_opaque_region(surface_wl, region);
+		wl_region_destroy(region);
+	}
+
 	void* Window::GetWindowHandler()
 	{
 		return surface_wl;
@@ -426,9 +492,10 @@ namespace Wayland
         
         if (resized)
         {
-            std::cout << fmt::format("Current Size: {},{}\n", width, height);
+            LOG(Info, "Current Size: {},{}", width, height);
 			wl_egl_window_resize(window_egl, width, height, 0, 0);
 			glViewport(0, 0, width, height);
+			set_opaque_region();
             
             resized = false;
         }
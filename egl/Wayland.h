@@ -110,5 +110,8 @@ namespace Wayland
 		bool  IsMinimized		(						);
 		
 		static void SetupStatics();
+
+	private:
+		void set_opaque_region();
 	};
 }
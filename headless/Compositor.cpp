@@ -0,0 +1,1388 @@
+#include "Compositor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/timerfd.h>
+
+#include <fmt/format.h>
+
+namespace Headless
+{
+	// Compiled by the client against its own xkb data, a plain US keyboard
+	static const char keymap[] =
+		"xkb_keymap {\n"
+		"\txkb_keycodes { include \"evdev+aliases(qwerty)\" };\n"
+		"\txkb_types    { include \"complete\"              };\n"
+		"\txkb_compat   { include \"complete\"              };\n"
+		"\txkb_symbols  { include \"pc+us+inet(evdev)\"     };\n"
+		"};\n";
+
+	namespace Implementations
+	{
+		extern const struct wl_compositor_interface              wl_compositor              ;
+		extern const struct wl_surface_interface                 wl_surface                 ;
+		extern const struct wl_region_interface                  wl_region                  ;
+		extern const struct wl_output_interface                  wl_output                  ;
+		extern const struct wl_seat_interface                    wl_seat                    ;
+		extern const struct wl_pointer_interface                 wl_pointer                 ;
+		extern const struct wl_keyboard_interface                wl_keyboard                ;
+		extern const struct wl_touch_interface                   wl_touch                   ;
+		extern const struct xdg_wm_base_interface                xdg_wm_base                ;
+		extern const struct xdg_surface_interface                xdg_surface                ;
+		extern const struct xdg_toplevel_interface               xdg_toplevel               ;
+		extern const struct zxdg_decoration_manager_v1_interface zxdg_decoration_manager_v1 ;
+		extern const struct zxdg_toplevel_decoration_v1_interface zxdg_toplevel_decoration_v1;
+		extern const struct wp_cursor_shape_manager_v1_interface  wp_cursor_shape_manager_v1 ;
+		extern const struct wp_cursor_shape_device_v1_interface   wp_cursor_shape_device_v1  ;
+		extern const struct wp_presentation_interface             wp_presentation            ;
+	}
+
+	namespace Functions
+	{
+		namespace Resource
+		{
+			// Every destroy and release request that has nothing else to do
+			void Destroy(wl_client* client, wl_resource* resource)
+			{
+				wl_resource_destroy(resource);
+			}
+		}
+
+		namespace WL_Buffer
+		{
+			void Destroyed(wl_listener* listener, void* data)
+			{
+				BufferRef* ref = (BufferRef*)listener;
+
+				wl_list_remove(&listener->link);
+				ref->resource = nullptr;
+			}
+		}
+
+		namespace WL_Callback
+		{
+			void Free(wl_resource* resource)
+			{
+				Surface* surface = (Surface*)wl_resource_get_user_data(resource);
+				if (surface == nullptr)
+					return;
+
+				std::erase(surface->pending_frames, resource);
+				std::erase(surface->frames        , resource);
+			}
+		}
+
+		namespace WP_Presentation_Feedback
+		{
+			void Free(wl_resource* resource)
+			{
+				Surface* surface = (Surface*)wl_resource_get_user_data(resource);
+				if (surface == nullptr)
+					return;
+
+				std::erase(surface->pending_feedback, resource);
+				std::erase(surface->feedback        , resource);
+			}
+		}
+
+		namespace WL_Compositor
+		{
+			void Bind(wl_client* client, void* data, uint32_t version, uint32_t id)
+			{
+				wl_resource* resource = wl_resource_create(client, &wl_compositor_interface, version, id);
+				if (resource == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(resource, &Implementations::wl_compositor, data, nullptr);
+			}
+
+			void Create_Surface(wl_client* client, wl_resource* resource, uint32_t id)
+			{
+				Compositor* compositor = (Compositor*)wl_resource_get_user_data(resource);
+
+				wl_resource* surface_resource = wl_resource_create(client, &wl_surface_interface, wl_resource_get_version(resource), id);
+				if (surface_resource == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				Surface* surface = new Surface;
+				surface->compositor = compositor      ;
+				surface->resource   = surface_resource;
+
+				wl_resource_set_implementation(surface_resource, &Implementations::wl_surface, surface, WL_Surface::Free);
+				compositor->surfaces.push_back(surface);
+			}
+
+			void Create_Region(wl_client* client, wl_resource* resource, uint32_t id)
+			{
+				wl_resource* region = wl_resource_create(client, &wl_region_interface, wl_resource_get_version(resource), id);
+				if (region == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(region, &Implementations::wl_region, nullptr, nullptr);
+			}
+		}
+
+		namespace WL_Region
+		{
+			void Add     (wl_client* client, wl_resource* resource, int32_t x, int32_t y, int32_t width, int32_t height) {}
+			void Subtract(wl_client* client, wl_resource* resource, int32_t x, int32_t y, int32_t width, int32_t height) {}
+		}
+
+		namespace WL_Surface
+		{
+			void Attach(wl_client* client, wl_resource* resource, wl_resource* buffer, int32_t x, int32_t y)
+			{
+				Surface* surface = (Surface*)wl_resource_get_user_data(resource);
+
+				surface->pending.Set(buffer);
+				surface->attached = true;
+			}
+
+			void Damage(wl_client* client, wl_resource* resource, int32_t x, int32_t y, int32_t width, int32_t height) {}
+
+			void Frame(wl_client* client, wl_resource* resource, uint32_t callback)
+			{
+				Surface* surface = (Surface*)wl_resource_get_user_data(resource);
+
+				wl_resource* callback_resource = wl_resource_create(client, &wl_callback_interface, 1, callback);
+				if (callback_resource == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(callback_resource, nullptr, surface, WL_Callback::Free);
+				surface->pending_frames.push_back(callback_resource);
+			}
+
+			void Set_Opaque_Region   (wl_client* client, wl_resource* resource, wl_resource* region) {}
+			void Set_Input_Region    (wl_client* client, wl_resource* resource, wl_resource* region) {}
+			void Set_Buffer_Transform(wl_client* client, wl_resource* resource, int32_t transform  ) {}
+
+			void Set_Buffer_Scale(wl_client* client, wl_resource* resource, int32_t scale)
+			{
+				Surface* surface = (Surface*)wl_resource_get_user_data(resource);
+				surface->pending_scale = scale;
+			}
+
+			void Damage_Buffer(wl_client* client, wl_resource* resource, int32_t x, int32_t y, int32_t width, int32_t height) {}
+
+			void Commit(wl_client* client, wl_resource* resource)
+			{
+				Surface   & surface    = *(Surface*)wl_resource_get_user_data(resource);
+				Compositor& compositor = *surface.compositor;
+
+				if (surface.attached)
+				{
+					// A buffer replaced before any refresh sampled it is handed straight back
+					if (surface.buffer.resource && surface.buffer.resource != surface.pending.resource)
+						compositor.release(surface);
+
+					surface.buffer.Set(surface.pending.resource);
+					surface.pending.Clear();
+					surface.attached  = false;
+					surface.committed = compositor.now_ns();
+				}
+
+				surface.scale = surface.pending_scale;
+
+				// A toplevel is on the one output from its first buffer on
+				if (surface.toplevel && surface.buffer.resource && !surface.entered)
+				{
+					for (wl_resource* output : compositor.outputs)
+						if (wl_resource_get_client(output) == client)
+						{
+							wl_surface_send_enter(resource, output);
+							compositor.enters++;
+						}
+
+					surface.entered = true;
+				}
+
+				surface.frames.insert(surface.frames.end(), surface.pending_frames.begin(), surface.pending_frames.end());
+				surface.pending_frames.clear();
+
+				// The last commit was replaced before a refresh could show it
+				for (wl_resource* feedback : surface.feedback)
+				{
+					wl_resource_set_user_data(feedback, nullptr);
+					wp_presentation_feedback_send_discarded(feedback);
+					wl_resource_destroy(feedback);
+				}
+
+				compositor.discarded += surface.feedback.size();
+				surface.feedback.swap(surface.pending_feedback);
+				surface.pending_feedback.clear();
+
+				compositor.commits++;
+
+				// xdg-shell answers the first commit of a new toplevel with a configure
+				if (surface.toplevel && !surface.configured)
+					compositor.configure(surface);
+
+				if (compositor.refresh == 0)
+					compositor.present(surface, compositor.now());
+			}
+
+			void Free(wl_resource* resource)
+			{
+				Surface   * surface    = (Surface*)wl_resource_get_user_data(resource);
+				Compositor& compositor = *surface->compositor;
+
+				// Whatever still points at the surface outlives it, so cut the links
+				for (wl_resource* callback : surface->pending_frames)
+					wl_resource_set_user_data(callback, nullptr);
+				for (wl_resource* callback : surface->frames)
+					wl_resource_set_user_data(callback, nullptr);
+				for (wl_resource* feedback : surface->pending_feedback)
+					wl_resource_set_user_data(feedback, nullptr);
+				for (wl_resource* feedback : surface->feedback)
+					wl_resource_set_user_data(feedback, nullptr);
+
+				if (surface->xdg_surface) wl_resource_set_user_data(surface->xdg_surface, nullptr);
+				if (surface->toplevel   ) wl_resource_set_user_data(surface->toplevel   , nullptr);
+				if (surface->decoration ) wl_resource_set_user_data(surface->decoration , nullptr);
+
+				surface->pending.Clear();
+				surface->buffer .Clear();
+
+				std::erase(compositor.surfaces, surface);
+				if (compositor.focus == surface)
+					compositor.focus = nullptr;
+				if (compositor.keyboard_focus == surface)
+					compositor.keyboard_focus = nullptr;
+				if (compositor.touch_focus == surface)
+					compositor.touch_focus = nullptr;
+
+				delete surface;
+			}
+		}
+
+		namespace WL_Output
+		{
+			void Bind(wl_client* client, void* data, uint32_t version, uint32_t id)
+			{
+				Compositor* compositor = (Compositor*)data;
+
+				wl_resource* resource = wl_resource_create(client, &wl_output_interface, version, id);
+				if (resource == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(resource, &Implementations::wl_output, compositor, WL_Output::Free);
+				compositor->outputs.push_back(resource);
+
+				wl_output_send_geometry(resource, 0, 0, 0, 0, WL_OUTPUT_SUBPIXEL_UNKNOWN, "headless", "headless", WL_OUTPUT_TRANSFORM_NORMAL);
+				compositor->send_output(resource);
+			}
+
+			void Free(wl_resource* resource)
+			{
+				Compositor* compositor = (Compositor*)wl_resource_get_user_data(resource);
+				std::erase(compositor->outputs, resource);
+			}
+		}
+
+		namespace WL_Seat
+		{
+			void Bind(wl_client* client, void* data, uint32_t version, uint32_t id)
+			{
+				wl_resource* resource = wl_resource_create(client, &wl_seat_interface, version, id);
+				if (resource == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(resource, &Implementations::wl_seat, data, nullptr);
+
+				wl_seat_send_capabilities(resource, WL_SEAT_CAPABILITY_POINTER | WL_SEAT_CAPABILITY_KEYBOARD | WL_SEAT_CAPABILITY_TOUCH);
+				if (version >= WL_SEAT_NAME_SINCE_VERSION)
+					wl_seat_send_name(resource, "headless");
+			}
+
+			void Get_Pointer(wl_client* client, wl_resource* resource, uint32_t id)
+			{
+				Compositor* compositor = (Compositor*)wl_resource_get_user_data(resource);
+
+				wl_resource* pointer = wl_resource_create(client, &wl_pointer_interface, wl_resource_get_version(resource), id);
+				if (pointer == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(pointer, &Implementations::wl_pointer, compositor, WL_Pointer::Free);
+				compositor->pointers.push_back(pointer);
+			}
+
+			void Get_Keyboard(wl_client* client, wl_resource* resource, uint32_t id)
+			{
+				Compositor* compositor = (Compositor*)wl_resource_get_user_data(resource);
+
+				wl_resource* keyboard = wl_resource_create(client, &wl_keyboard_interface, wl_resource_get_version(resource), id);
+				if (keyboard == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(keyboard, &Implementations::wl_keyboard, compositor, WL_Keyboard::Free);
+				compositor->keyboards.push_back(keyboard);
+
+				wl_keyboard_send_keymap(keyboard, WL_KEYBOARD_KEYMAP_FORMAT_XKB_V1, compositor->keymap_fd, compositor->keymap_size);
+
+				if (wl_resource_get_version(keyboard) >= WL_KEYBOARD_REPEAT_INFO_SINCE_VERSION)
+					wl_keyboard_send_repeat_info(keyboard, 25, 600);
+			}
+
+			void Get_Touch(wl_client* client, wl_resource* resource, uint32_t id)
+			{
+				Compositor* compositor = (Compositor*)wl_resource_get_user_data(resource);
+
+				wl_resource* touch = wl_resource_create(client, &wl_touch_interface, wl_resource_get_version(resource), id);
+				if (touch == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(touch, &Implementations::wl_touch, compositor, WL_Touch::Free);
+				compositor->touches.push_back(touch);
+			}
+		}
+
+		namespace WL_Pointer
+		{
+			void Set_Cursor(wl_client* client, wl_resource* resource, uint32_t serial, wl_resource* surface, int32_t hotspot_x, int32_t hotspot_y)
+			{
+				Compositor* compositor = (Compositor*)wl_resource_get_user_data(resource);
+				if (surface)
+					compositor->cursors++;
+			}
+
+			void Free(wl_resource* resource)
+			{
+				Compositor* compositor = (Compositor*)wl_resource_get_user_data(resource);
+				std::erase(compositor->pointers, resource);
+			}
+		}
+
+		namespace WL_Keyboard
+		{
+			void Free(wl_resource* resource)
+			{
+				Compositor* compositor = (Compositor*)wl_resource_get_user_data(resource);
+				std::erase(compositor->keyboards, resource);
+			}
+		}
+
+		namespace WL_Touch
+		{
+			void Free(wl_resource* resource)
+			{
+				Compositor* compositor = (Compositor*)wl_resource_get_user_data(resource);
+				std::erase(compositor->touches, resource);
+			}
+		}
+
+		namespace WP_Cursor_Shape_Manager_V1
+		{
+			void Bind(wl_client* client, void* data, uint32_t version, uint32_t id)
+			{
+				wl_resource* resource = wl_resource_create(client, &wp_cursor_shape_manager_v1_interface, version, id);
+				if (resource == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(resource, &Implementations::wp_cursor_shape_manager_v1, data, nullptr);
+			}
+
+			void Get_Device(wl_client* client, wl_resource* resource, uint32_t id, wl_resource* device)
+			{
+				wl_resource* shape_device = wl_resource_create(client, &wp_cursor_shape_device_v1_interface, wl_resource_get_version(resource), id);
+				if (shape_device == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(shape_device, &Implementations::wp_cursor_shape_device_v1, wl_resource_get_user_data(resource), nullptr);
+			}
+		}
+
+		namespace WP_Cursor_Shape_Device_V1
+		{
+			void Set_Shape(wl_client* client, wl_resource* resource, uint32_t serial, uint32_t shape)
+			{
+				if (shape < WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_DEFAULT || shape > WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_ZOOM_OUT)
+				{
+					wl_resource_post_error(resource, WP_CURSOR_SHAPE_DEVICE_V1_ERROR_INVALID_SHAPE, "Invalid cursor shape %u", shape);
+					return;
+				}
+
+				Compositor* compositor = (Compositor*)wl_resource_get_user_data(resource);
+				compositor->shapes++;
+			}
+		}
+
+		namespace WP_Presentation
+		{
+			void Bind(wl_client* client, void* data, uint32_t version, uint32_t id)
+			{
+				wl_resource* resource = wl_resource_create(client, &wp_presentation_interface, version, id);
+				if (resource == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(resource, &Implementations::wp_presentation, data, nullptr);
+
+				// Presentation times are taken from the same clock as everything else here
+				wp_presentation_send_clock_id(resource, CLOCK_MONOTONIC);
+			}
+
+			void Feedback(wl_client* client, wl_resource* resource, wl_resource* surface, uint32_t callback)
+			{
+				wl_resource* feedback = wl_resource_create(client, &wp_presentation_feedback_interface, wl_resource_get_version(resource), callback);
+				if (feedback == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				Surface* target = (Surface*)wl_resource_get_user_data(surface);
+
+				wl_resource_set_implementation(feedback, nullptr, target, WP_Presentation_Feedback::Free);
+				target->pending_feedback.push_back(feedback);
+			}
+		}
+
+		namespace XDG_Toplevel
+		{
+			void Set_Parent      (wl_client* client, wl_resource* resource, wl_resource* parent                                     ) {}
+			void Set_Title       (wl_client* client, wl_resource* resource, const char* title                                       ) {}
+			void Set_App_Id      (wl_client* client, wl_resource* resource, const char* app_id                                      ) {}
+			void Show_Window_Menu(wl_client* client, wl_resource* resource, wl_resource* seat, uint32_t serial, int32_t x, int32_t y) {}
+			void Move            (wl_client* client, wl_resource* resource, wl_resource* seat, uint32_t serial                      ) {}
+			void Resize          (wl_client* client, wl_resource* resource, wl_resource* seat, uint32_t serial, uint32_t edges      ) {}
+			void Set_Max_Size    (wl_client* client, wl_resource* resource, int32_t width, int32_t height                           ) {}
+			void Set_Min_Size    (wl_client* client, wl_resource* resource, int32_t width, int32_t height                           ) {}
+			void Set_Maximized   (wl_client* client, wl_resource* resource                                                          ) {}
+			void Unset_Maximized (wl_client* client, wl_resource* resource                                                          ) {}
+			void Set_Fullscreen  (wl_client* client, wl_resource* resource, wl_resource* output                                     ) {}
+			void Unset_Fullscreen(wl_client* client, wl_resource* resource                                                          ) {}
+			void Set_Minimized   (wl_client* client, wl_resource* resource                                                          ) {}
+
+			void Free(wl_resource* resource)
+			{
+				Surface* surface = (Surface*)wl_resource_get_user_data(resource);
+				if (surface)
+				{
+					surface->toplevel   = nullptr;
+					surface->configured = false  ;
+				}
+			}
+		}
+
+		namespace XDG_Surface
+		{
+			void Get_Toplevel(wl_client* client, wl_resource* resource, uint32_t id)
+			{
+				Surface* surface = (Surface*)wl_resource_get_user_data(resource);
+
+				wl_resource* toplevel = wl_resource_create(client, &xdg_toplevel_interface, wl_resource_get_version(resource), id);
+				if (toplevel == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(toplevel, &Implementations::xdg_toplevel, surface, XDG_Toplevel::Free);
+				if (surface)
+					surface->toplevel = toplevel;
+			}
+
+			void Get_Popup(wl_client* client, wl_resource* resource, uint32_t id, wl_resource* parent, wl_resource* positioner)
+			{
+				wl_client_post_implementation_error(client, "the headless compositor has no popups");
+			}
+
+			void Set_Window_Geometry(wl_client* client, wl_resource* resource, int32_t x, int32_t y, int32_t width, int32_t height) {}
+			void Ack_Configure      (wl_client* client, wl_resource* resource, uint32_t serial                                  ) {}
+
+			void Free(wl_resource* resource)
+			{
+				Surface* surface = (Surface*)wl_resource_get_user_data(resource);
+				if (surface)
+					surface->xdg_surface = nullptr;
+			}
+		}
+
+		namespace XDG_WM_Base
+		{
+			void Bind(wl_client* client, void* data, uint32_t version, uint32_t id)
+			{
+				wl_resource* resource = wl_resource_create(client, &xdg_wm_base_interface, version, id);
+				if (resource == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(resource, &Implementations::xdg_wm_base, data, nullptr);
+			}
+
+			void Create_Positioner(wl_client* client, wl_resource* resource, uint32_t id)
+			{
+				wl_client_post_implementation_error(client, "the headless compositor has no popups");
+			}
+
+			void Get_Xdg_Surface(wl_client* client, wl_resource* resource, uint32_t id, wl_resource* surface_resource)
+			{
+				Surface* surface = (Surface*)wl_resource_get_user_data(surface_resource);
+
+				wl_resource* xdg_surface = wl_resource_create(client, &xdg_surface_interface, wl_resource_get_version(resource), id);
+				if (xdg_surface == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(xdg_surface, &Implementations::xdg_surface, surface, XDG_Surface::Free);
+				surface->xdg_surface = xdg_surface;
+			}
+
+			void Pong(wl_client* client, wl_resource* resource, uint32_t serial) {}
+		}
+
+		namespace ZXDG_Toplevel_Decoration_V1
+		{
+			void Set_Mode(wl_client* client, wl_resource* resource, uint32_t mode)
+			{
+				Surface* surface = (Surface*)wl_resource_get_user_data(resource);
+
+				// Nothing is drawn either way, so the client always gets what it asked for
+				zxdg_toplevel_decoration_v1_send_configure(resource, mode);
+
+				if (surface && surface->xdg_surface && surface->configured)
+					xdg_surface_send_configure(surface->xdg_surface, wl_display_next_serial(wl_client_get_display(client)));
+			}
+
+			void Unset_Mode(wl_client* client, wl_resource* resource)
+			{
+				Set_Mode(client, resource, ZXDG_TOPLEVEL_DECORATION_V1_MODE_CLIENT_SIDE);
+			}
+
+			void Free(wl_resource* resource)
+			{
+				Surface* surface = (Surface*)wl_resource_get_user_data(resource);
+				if (surface)
+					surface->decoration = nullptr;
+			}
+		}
+
+		namespace ZXDG_Decoration_Manager_V1
+		{
+			void Bind(wl_client* client, void* data, uint32_t version, uint32_t id)
+			{
+				wl_resource* resource = wl_resource_create(client, &zxdg_decoration_manager_v1_interface, version, id);
+				if (resource == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(resource, &Implementations::zxdg_decoration_manager_v1, data, nullptr);
+			}
+
+			void Get_Toplevel_Decoration(wl_client* client, wl_resource* resource, uint32_t id, wl_resource* toplevel)
+			{
+				Surface* surface = (Surface*)wl_resource_get_user_data(toplevel);
+
+				wl_resource* decoration = wl_resource_create(client, &zxdg_toplevel_decoration_v1_interface, wl_resource_get_version(resource), id);
+				if (decoration == nullptr)
+				{
+					wl_client_post_no_memory(client);
+					return;
+				}
+
+				wl_resource_set_implementation(decoration, &Implementations::zxdg_toplevel_decoration_v1, surface, ZXDG_Toplevel_Decoration_V1::Free);
+				if (surface)
+					surface->decoration = decoration;
+			}
+		}
+
+		namespace Loop
+		{
+			int Wake(int fd, uint32_t mask, void* data)
+			{
+				Compositor& compositor = *(Compositor*)data;
+
+				uint64_t count;
+				if (read(fd, &count, sizeof(count)) != sizeof(count))
+					return 0;
+
+				std::vector<std::function<void()>> commands;
+				{
+					std::lock_guard<std::mutex> lock(compositor.mutex);
+					commands.swap(compositor.commands);
+				}
+
+				for (std::function<void()>& command : commands)
+					command();
+
+				return 0;
+			}
+
+			int VBlank(int fd, uint32_t mask, void* data)
+			{
+				Compositor& compositor = *(Compositor*)data;
+
+				uint64_t expirations;
+				if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations) || compositor.refresh == 0)
+					return 0;
+
+				// Refreshes missed while the thread was busy are skipped, like a real output would
+				compositor.frame += expirations;
+				compositor.frames++;
+
+				uint32_t time = compositor.frame * 1000000 / compositor.refresh;
+				for (Surface* surface : compositor.surfaces)
+					compositor.present(*surface, time);
+
+				return 0;
+			}
+		}
+	}
+
+	namespace Implementations
+	{
+		const struct wl_compositor_interface wl_compositor
+		{
+			.create_surface = Functions::WL_Compositor::Create_Surface,
+			.create_region  = Functions::WL_Compositor::Create_Region
+		};
+
+		const struct wl_surface_interface wl_surface
+		{
+			.destroy              = Functions::Resource  ::Destroy,
+			.attach               = Functions::WL_Surface::Attach,
+			.damage               = Functions::WL_Surface::Damage,
+			.frame                = Functions::WL_Surface::Frame,
+			.set_opaque_region    = Functions::WL_Surface::Set_Opaque_Region,
+			.set_input_region     = Functions::WL_Surface::Set_Input_Region,
+			.commit               = Functions::WL_Surface::Commit,
+			.set_buffer_transform = Functions::WL_Surface::Set_Buffer_Transform,
+			.set_buffer_scale     = Functions::WL_Surface::Set_Buffer_Scale,
+			.damage_buffer        = Functions::WL_Surface::Damage_Buffer
+		};
+
+		const struct wl_region_interface wl_region
+		{
+			.destroy  = Functions::Resource ::Destroy,
+			.add      = Functions::WL_Region::Add,
+			.subtract = Functions::WL_Region::Subtract
+		};
+
+		const struct wl_output_interface wl_output
+		{
+			.release = Functions::Resource::Destroy
+		};
+
+		const struct wl_seat_interface wl_seat
+		{
+			.get_pointer  = Functions::WL_Seat ::Get_Pointer,
+			.get_keyboard = Functions::WL_Seat ::Get_Keyboard,
+			.get_touch    = Functions::WL_Seat ::Get_Touch,
+			.release      = Functions::Resource::Destroy
+		};
+
+		const struct wl_pointer_interface wl_pointer
+		{
+			.set_cursor = Functions::WL_Pointer::Set_Cursor,
+			.release    = Functions::Resource  ::Destroy
+		};
+
+		const struct wl_keyboard_interface wl_keyboard
+		{
+			.release = Functions::Resource::Destroy
+		};
+
+		const struct wl_touch_interface wl_touch
+		{
+			.release = Functions::Resource::Destroy
+		};
+
+		const struct xdg_wm_base_interface xdg_wm_base
+		{
+			.destroy           = Functions::Resource   ::Destroy,
+			.create_positioner = Functions::XDG_WM_Base::Create_Positioner,
+			.get_xdg_surface   = Functions::XDG_WM_Base::Get_Xdg_Surface,
+			.pong              = Functions::XDG_WM_Base::Pong
+		};
+
+		const struct xdg_surface_interface xdg_surface
+		{
+			.destroy             = Functions::Resource   ::Destroy,
+			.get_toplevel        = Functions::XDG_Surface::Get_Toplevel,
+			.get_popup           = Functions::XDG_Surface::Get_Popup,
+			.set_window_geometry = Functions::XDG_Surface::Set_Window_Geometry,
+			.ack_configure       = Functions::XDG_Surface::Ack_Configure
+		};
+
+		const struct xdg_toplevel_interface xdg_toplevel
+		{
+			.destroy          = Functions::Resource    ::Destroy,
+			.set_parent       = Functions::XDG_Toplevel::Set_Parent,
+			.set_title        = Functions::XDG_Toplevel::Set_Title,
+			.set_app_id       = Functions::XDG_Toplevel::Set_App_Id,
+			.show_window_menu = Functions::XDG_Toplevel::Show_Window_Menu,
+			.move             = Functions::XDG_Toplevel::Move,
+			.resize           = Functions::XDG_Toplevel::Resize,
+			.set_max_size     = Functions::XDG_Toplevel::Set_Max_Size,
+			.set_min_size     = Functions::XDG_Toplevel::Set_Min_Size,
+			.set_maximized    = Functions::XDG_Toplevel::Set_Maximized,
+			.unset_maximized  = Functions::XDG_Toplevel::Unset_Maximized,
+			.set_fullscreen   = Functions::XDG_Toplevel::Set_Fullscreen,
+			.unset_fullscreen = Functions::XDG_Toplevel::Unset_Fullscreen,
+			.set_minimized    = Functions::XDG_Toplevel::Set_Minimized
+		};
+
+		const struct zxdg_decoration_manager_v1_interface zxdg_decoration_manager_v1
+		{
+			.destroy                 = Functions::Resource                  ::Destroy,
+			.get_toplevel_decoration = Functions::ZXDG_Decoration_Manager_V1::Get_Toplevel_Decoration
+		};
+
+		const struct wp_cursor_shape_manager_v1_interface wp_cursor_shape_manager_v1
+		{
+			.destroy            = Functions::Resource                 ::Destroy,
+			.get_pointer        = Functions::WP_Cursor_Shape_Manager_V1::Get_Device,
+			.get_tablet_tool_v2 = Functions::WP_Cursor_Shape_Manager_V1::Get_Device
+		};
+
+		const struct wp_cursor_shape_device_v1_interface wp_cursor_shape_device_v1
+		{
+			.destroy   = Functions::Resource                ::Destroy,
+			.set_shape = Functions::WP_Cursor_Shape_Device_V1::Set_Shape
+		};
+
+		const struct wp_presentation_interface wp_presentation
+		{
+			.destroy  = Functions::Resource       ::Destroy,
+			.feedback = Functions::WP_Presentation::Feedback
+		};
+
+		const struct zxdg_toplevel_decoration_v1_interface zxdg_toplevel_decoration_v1
+		{
+			.destroy    = Functions::Resource                   ::Destroy,
+			.set_mode   = Functions::ZXDG_Toplevel_Decoration_V1::Set_Mode,
+			.unset_mode = Functions::ZXDG_Toplevel_Decoration_V1::Unset_Mode
+		};
+	}
+
+	void BufferRef::Set(wl_resource* resource)
+	{
+		Clear();
+
+		if (resource == nullptr)
+			return;
+
+		destroy.notify = Functions::WL_Buffer::Destroyed;
+		wl_resource_add_destroy_listener(resource, &destroy);
+
+		this->resource = resource;
+	}
+
+	void BufferRef::Clear()
+	{
+		if (resource == nullptr)
+			return;
+
+		wl_list_remove(&destroy.link);
+		resource = nullptr;
+	}
+
+	Compositor::~Compositor()
+	{
+		Stop();
+	}
+
+	void Compositor::Start(uint32_t refresh)
+	{
+		if (display)
+			throw std::runtime_error("Compositor already started");
+
+		display = wl_display_create();
+		if (display == nullptr)
+			throw std::runtime_error("Could not create a wayland display");
+
+		// Headless boxes often have no session, and so nowhere to put the socket
+		if (getenv("XDG_RUNTIME_DIR") == nullptr)
+		{
+			static char runtime_dir[] = "/tmp/headless-XXXXXX";
+			if (mkdtemp(runtime_dir) == nullptr)
+				throw std::runtime_error(fmt::format("Could not create a runtime dir: {}", strerror(errno)));
+
+			setenv("XDG_RUNTIME_DIR", runtime_dir, 1);
+		}
+
+		const char* name = wl_display_add_socket_auto(display);
+		if (name == nullptr)
+			throw std::runtime_error("Could not add a wayland socket");
+
+		socket = name;
+		setenv("WAYLAND_DISPLAY", name, 1);
+
+		// Sent with its terminating null, which the size counts
+		keymap_fd   = memfd_create("headless-keymap", MFD_CLOEXEC);
+		keymap_size = sizeof(keymap);
+		if (keymap_fd < 0 || write(keymap_fd, keymap, keymap_size) != (ssize_t)keymap_size)
+			throw std::runtime_error(fmt::format("Could not create the keymap: {}", strerror(errno)));
+
+		// ARGB8888 and XRGB8888 come with wl_shm, the rest are what the clients can convert to
+		wl_display_init_shm(display);
+		wl_display_add_shm_format(display, WL_SHM_FORMAT_RGB565     );
+		wl_display_add_shm_format(display, WL_SHM_FORMAT_XRGB2101010);
+
+		wl_global_create(display, &wl_compositor_interface             , 4, this, Functions::WL_Compositor             ::Bind);
+		wl_global_create(display, &wl_output_interface                 , 3, this, Functions::WL_Output                 ::Bind);
+		wl_global_create(display, &wl_seat_interface                   , 5, this, Functions::WL_Seat                   ::Bind);
+		wl_global_create(display, &xdg_wm_base_interface               , 2, this, Functions::XDG_WM_Base               ::Bind);
+		wl_global_create(display, &zxdg_decoration_manager_v1_interface, 1, this, Functions::ZXDG_Decoration_Manager_V1::Bind);
+		wl_global_create(display, &wp_presentation_interface           , 1, this, Functions::WP_Presentation           ::Bind);
+
+		if (shapes_offered)
+			wl_global_create(display, &wp_cursor_shape_manager_v1_interface, 1, this, Functions::WP_Cursor_Shape_Manager_V1::Bind);
+
+		wake_fd   = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		vblank_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+		if (wake_fd < 0 || vblank_fd < 0)
+			throw std::runtime_error(fmt::format("Could not create the compositor fds: {}", strerror(errno)));
+
+		loop          = wl_display_get_event_loop(display);
+		wake_source   = wl_event_loop_add_fd(loop, wake_fd  , WL_EVENT_READABLE, Functions::Loop::Wake  , this);
+		vblank_source = wl_event_loop_add_fd(loop, vblank_fd, WL_EVENT_READABLE, Functions::Loop::VBlank, this);
+
+		this->refresh = refresh;
+		arm();
+
+		running = true;
+		thread  = std::thread([this]
+		{
+			while (running)
+			{
+				wl_display_flush_clients(display);
+				wl_event_loop_dispatch(loop, -1);
+			}
+		});
+	}
+
+	void Compositor::Stop()
+	{
+		if (display == nullptr)
+			return;
+
+		post([this] { running = false; });
+		thread.join();
+
+		wl_display_destroy_clients(display);
+
+		wl_event_source_remove(wake_source  );
+		wl_event_source_remove(vblank_source);
+		close(wake_fd  );
+		close(vblank_fd);
+		close(keymap_fd);
+
+		wl_display_destroy(display);
+
+		display        = nullptr;
+		wake_fd        = -1     ;
+		vblank_fd      = -1     ;
+		keymap_fd      = -1     ;
+		focus          = nullptr;
+		keyboard_focus = nullptr;
+		touch_focus    = nullptr;
+		commands.clear();
+		seats.clear();
+	}
+
+	const char* Compositor::Socket()
+	{
+		return socket.c_str();
+	}
+
+	Compositor::Stats Compositor::GetStats()
+	{
+		return Stats{ frames, commits, releases, cursors, shapes, presented, discarded, enters, scale, release_latency_total, release_latency_max };
+	}
+
+	void Compositor::SetCursorShapes(bool enabled)
+	{
+		shapes_offered = enabled;
+	}
+
+	void Compositor::SetOutputScale(int32_t scale)
+	{
+		output_scale = scale;
+	}
+
+	void Compositor::post(std::function<void()> command)
+	{
+		// Before Start there is no thread to race with
+		if (!thread.joinable())
+		{
+			command();
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			commands.push_back(std::move(command));
+		}
+
+		uint64_t one = 1;
+		if (write(wake_fd, &one, sizeof(one)) != sizeof(one))
+			throw std::runtime_error(fmt::format("Could not wake the compositor: {}", strerror(errno)));
+	}
+
+	void Compositor::arm()
+	{
+		itimerspec spec = {};
+
+		if (refresh)
+		{
+			uint64_t period = 1000000000000ull / refresh;
+
+			spec.it_interval.tv_sec  = period / 1000000000;
+			spec.it_interval.tv_nsec = period % 1000000000;
+			spec.it_value            = spec.it_interval;
+		}
+
+		timerfd_settime(vblank_fd, 0, &spec, nullptr);
+	}
+
+	uint32_t Compositor::now()
+	{
+		timespec time;
+		clock_gettime(CLOCK_MONOTONIC, &time);
+
+		return time.tv_sec * 1000 + time.tv_nsec / 1000000;
+	}
+
+	uint64_t Compositor::now_ns()
+	{
+		timespec time;
+		clock_gettime(CLOCK_MONOTONIC, &time);
+
+		return time.tv_sec * 1000000000ull + time.tv_nsec;
+	}
+
+	void Compositor::present(Surface& surface, uint32_t time)
+	{
+		// A copying renderer is done with the buffer once it has sampled it
+		if (surface.buffer.resource)
+		{
+			if (wl_shm_buffer* shm_buffer = wl_shm_buffer_get(surface.buffer.resource))
+			{
+				surface.width  = wl_shm_buffer_get_width (shm_buffer);
+				surface.height = wl_shm_buffer_get_height(shm_buffer);
+				surface.format = wl_shm_buffer_get_format(shm_buffer);
+			}
+
+			if (surface.toplevel)
+				scale = surface.scale;
+
+			release(surface);
+		}
+
+		std::vector<wl_resource*> callbacks;
+		callbacks.swap(surface.frames);
+
+		for (wl_resource* callback : callbacks)
+		{
+			wl_resource_set_user_data(callback, nullptr);
+			wl_callback_send_done(callback, time);
+			wl_resource_destroy(callback);
+		}
+
+		if (surface.feedback.empty())
+			return;
+
+		// Shown the moment the virtual refresh fires. Presenting on commit has no
+		// refresh cycle to report, so refresh, the counter and vsync are left out.
+		uint64_t shown   = now_ns();
+		uint32_t period  = refresh ? 1000000000000ull / refresh : 0;
+		uint64_t counter = refresh ? frame : 0;
+		uint32_t flags   = refresh ? WP_PRESENTATION_FEEDBACK_KIND_VSYNC : 0;
+
+		std::vector<wl_resource*> feedback;
+		feedback.swap(surface.feedback);
+
+		for (wl_resource* resource : feedback)
+		{
+			// Synchronized to the one output, when there is a refresh to synchronize to
+			if (refresh)
+				for (wl_resource* output : outputs)
+					if (wl_resource_get_client(output) == wl_resource_get_client(resource))
+						wp_presentation_feedback_send_sync_output(resource, output);
+
+			wl_resource_set_user_data(resource, nullptr);
+			wp_presentation_feedback_send_presented(resource, shown / 1000000000 >> 32, shown / 1000000000 & 0xFFFFFFFF, shown % 1000000000, period, counter >> 32, counter & 0xFFFFFFFF, flags);
+			wl_resource_destroy(resource);
+		}
+
+		presented += feedback.size();
+	}
+
+	void Compositor::release(Surface& surface)
+	{
+		uint64_t latency = now_ns() - surface.committed;
+
+		release_latency_total += latency;
+		if (latency > release_latency_max)
+			release_latency_max = latency;
+
+		wl_buffer_send_release(surface.buffer.resource);
+		surface.buffer.Clear();
+		releases++;
+	}
+
+	// A mode as big as the toplevels are likely to be configured to, at the virtual refresh
+	void Compositor::send_output(wl_resource* output)
+	{
+		wl_output_send_mode(output, WL_OUTPUT_MODE_CURRENT | WL_OUTPUT_MODE_PREFERRED, 1920, 1080, refresh);
+
+		if (wl_resource_get_version(output) >= WL_OUTPUT_SCALE_SINCE_VERSION)
+			wl_output_send_scale(output, output_scale);
+		if (wl_resource_get_version(output) >= WL_OUTPUT_DONE_SINCE_VERSION)
+			wl_output_send_done(output);
+	}
+
+	void Compositor::configure(Surface& surface)
+	{
+		wl_array array;
+		wl_array_init(&array);
+
+		for (uint32_t state : states)
+			*(uint32_t*)wl_array_add(&array, sizeof(uint32_t)) = state;
+
+		xdg_toplevel_send_configure(surface.toplevel, width, height, &array);
+		xdg_surface_send_configure(surface.xdg_surface, wl_display_next_serial(display));
+
+		wl_array_release(&array);
+
+		surface.configured = true;
+	}
+
+	std::vector<wl_resource*> Compositor::focus_pointers()
+	{
+		std::vector<wl_resource*> result;
+		if (focus == nullptr)
+			return result;
+
+		wl_client* client = wl_resource_get_client(focus->resource);
+		for (wl_resource* pointer : pointers)
+			if (wl_resource_get_client(pointer) == client)
+				result.push_back(pointer);
+
+		return result;
+	}
+
+	void Compositor::pointer_frame(wl_resource* pointer)
+	{
+		if (wl_resource_get_version(pointer) >= WL_POINTER_FRAME_SINCE_VERSION)
+			wl_pointer_send_frame(pointer);
+	}
+
+	void Compositor::SetRefresh(uint32_t refresh)
+	{
+		post([this, refresh]
+		{
+			this->refresh = refresh;
+			arm();
+
+			for (wl_resource* output : outputs)
+				send_output(output);
+
+			// Anything waiting on the old refresh would otherwise wait forever
+			if (refresh == 0)
+				for (Surface* surface : surfaces)
+					present(*surface, now());
+		});
+	}
+
+	void Compositor::Configure(int width, int height, std::vector<uint32_t> states)
+	{
+		post([this, width, height, states]
+		{
+			this->width  = width ;
+			this->height = height;
+			this->states = states;
+
+			for (Surface* surface : surfaces)
+				if (surface->toplevel && surface->configured)
+					configure(*surface);
+		});
+	}
+
+	void Compositor::Close()
+	{
+		post([this]
+		{
+			for (Surface* surface : surfaces)
+				if (surface->toplevel)
+					xdg_toplevel_send_close(surface->toplevel);
+		});
+	}
+
+	void Compositor::PointerEnter(double x, double y)
+	{
+		post([this, x, y]
+		{
+			Surface* target = nullptr;
+			for (Surface* surface : surfaces)
+				if (surface->toplevel)
+					target = surface;
+
+			if (target == nullptr)
+				return;
+
+			if (focus && focus != target)
+				for (wl_resource* pointer : focus_pointers())
+				{
+					wl_pointer_send_leave(pointer, wl_display_next_serial(display), focus->resource);
+					pointer_frame(pointer);
+				}
+
+			focus     = target;
+			pointer_x = x     ;
+			pointer_y = y     ;
+
+			for (wl_resource* pointer : focus_pointers())
+			{
+				wl_pointer_send_enter(pointer, wl_display_next_serial(display), focus->resource, wl_fixed_from_double(x), wl_fixed_from_double(y));
+				pointer_frame(pointer);
+			}
+		});
+	}
+
+	void Compositor::PointerLeave()
+	{
+		post([this]
+		{
+			for (wl_resource* pointer : focus_pointers())
+			{
+				wl_pointer_send_leave(pointer, wl_display_next_serial(display), focus->resource);
+				pointer_frame(pointer);
+			}
+
+			focus = nullptr;
+		});
+	}
+
+	void Compositor::PointerMotion(double x, double y)
+	{
+		post([this, x, y]
+		{
+			pointer_x = x;
+			pointer_y = y;
+
+			for (wl_resource* pointer : focus_pointers())
+			{
+				wl_pointer_send_motion(pointer, now(), wl_fixed_from_double(x), wl_fixed_from_double(y));
+				pointer_frame(pointer);
+			}
+		});
+	}
+
+	void Compositor::PointerButton(uint32_t button, bool pressed)
+	{
+		post([this, button, pressed]
+		{
+			uint32_t state = pressed ? WL_POINTER_BUTTON_STATE_PRESSED : WL_POINTER_BUTTON_STATE_RELEASED;
+
+			for (wl_resource* pointer : focus_pointers())
+			{
+				wl_pointer_send_button(pointer, wl_display_next_serial(display), now(), button, state);
+				pointer_frame(pointer);
+			}
+		});
+	}
+
+	void Compositor::PointerAxis(uint32_t axis, double value)
+	{
+		post([this, axis, value]
+		{
+			for (wl_resource* pointer : focus_pointers())
+			{
+				wl_pointer_send_axis(pointer, now(), axis, wl_fixed_from_double(value));
+				pointer_frame(pointer);
+			}
+		});
+	}
+
+	void Compositor::AddSeat()
+	{
+		post([this]
+		{
+			seats.push_back(wl_global_create(display, &wl_seat_interface, 5, this, Functions::WL_Seat::Bind));
+		});
+	}
+
+	void Compositor::RemoveSeat()
+	{
+		post([this]
+		{
+			if (seats.empty())
+				return;
+
+			wl_global_destroy(seats.back());
+			seats.pop_back();
+		});
+	}
+
+	std::vector<wl_resource*> Compositor::focus_keyboards()
+	{
+		std::vector<wl_resource*> result;
+		if (keyboard_focus == nullptr)
+			return result;
+
+		wl_client* client = wl_resource_get_client(keyboard_focus->resource);
+		for (wl_resource* keyboard : keyboards)
+			if (wl_resource_get_client(keyboard) == client)
+				result.push_back(keyboard);
+
+		return result;
+	}
+
+	void Compositor::KeyboardEnter()
+	{
+		post([this]
+		{
+			Surface* target = nullptr;
+			for (Surface* surface : surfaces)
+				if (surface->toplevel)
+					target = surface;
+
+			if (target == nullptr || target == keyboard_focus)
+				return;
+
+			for (wl_resource* keyboard : focus_keyboards())
+				wl_keyboard_send_leave(keyboard, wl_display_next_serial(display), keyboard_focus->resource);
+
+			keyboard_focus = target;
+
+			wl_array keys;
+			wl_array_init(&keys);
+
+			for (wl_resource* keyboard : focus_keyboards())
+			{
+				wl_keyboard_send_enter(keyboard, wl_display_next_serial(display), keyboard_focus->resource, &keys);
+				wl_keyboard_send_modifiers(keyboard, wl_display_next_serial(display), 0, 0, 0, 0);
+			}
+
+			wl_array_release(&keys);
+		});
+	}
+
+	void Compositor::Key(uint32_t key, bool pressed)
+	{
+		post([this, key, pressed]
+		{
+			for (wl_resource* keyboard : focus_keyboards())
+				wl_keyboard_send_key(keyboard, wl_display_next_serial(display), now(), key, pressed ? WL_KEYBOARD_KEY_STATE_PRESSED : WL_KEYBOARD_KEY_STATE_RELEASED);
+		});
+	}
+
+	void Compositor::Modifiers(uint32_t depressed, uint32_t locked)
+	{
+		post([this, depressed, locked]
+		{
+			for (wl_resource* keyboard : focus_keyboards())
+				wl_keyboard_send_modifiers(keyboard, wl_display_next_serial(display), depressed, 0, locked, 0);
+		});
+	}
+
+	std::vector<wl_resource*> Compositor::focus_touches()
+	{
+		std::vector<wl_resource*> result;
+		if (touch_focus == nullptr)
+			return result;
+
+		wl_client* client = wl_resource_get_client(touch_focus->resource);
+		for (wl_resource* touch : touches)
+			if (wl_resource_get_client(touch) == client)
+				result.push_back(touch);
+
+		return result;
+	}
+
+	void Compositor::TouchDown(int32_t id, double x, double y)
+	{
+		post([this, id, x, y]
+		{
+			if (touch_focus == nullptr)
+				for (Surface* surface : surfaces)
+					if (surface->toplevel)
+						touch_focus = surface;
+
+			if (touch_focus == nullptr)
+				return;
+
+			for (wl_resource* touch : focus_touches())
+				wl_touch_send_down(touch, wl_display_next_serial(display), now(), touch_focus->resource, id, wl_fixed_from_double(x), wl_fixed_from_double(y));
+		});
+	}
+
+	void Compositor::TouchMotion(int32_t id, double x, double y)
+	{
+		post([this, id, x, y]
+		{
+			for (wl_resource* touch : focus_touches())
+				wl_touch_send_motion(touch, now(), id, wl_fixed_from_double(x), wl_fixed_from_double(y));
+		});
+	}
+
+	void Compositor::TouchUp(int32_t id)
+	{
+		post([this, id]
+		{
+			for (wl_resource* touch : focus_touches())
+				wl_touch_send_up(touch, wl_display_next_serial(display), now(), id);
+		});
+	}
+
+	void Compositor::TouchFrame()
+	{
+		post([this]
+		{
+			for (wl_resource* touch : focus_touches())
+				wl_touch_send_frame(touch);
+		});
+	}
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include <wayland-server.h>
+
+#include "xdg-shell-server-protocol.h"
+#include "xdg-decoration-server-protocol.h"
+#include "cursor-shape-v1-server-protocol.h"
+#include "presentation-time-server-protocol.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Headless
+{
+	class Compositor;
+
+	namespace Functions
+	{
+		namespace WL_Compositor
+		{
+			void Create_Surface(wl_client*, wl_resource*, uint32_t);
+		}
+
+		namespace WL_Surface
+		{
+			void Commit(wl_client*, wl_resource*);
+			void Free(wl_resource*);
+		}
+
+		namespace WL_Output
+		{
+			void Bind(wl_client*, void*, uint32_t, uint32_t);
+			void Free(wl_resource*);
+		}
+
+		namespace WL_Seat
+		{
+			void Get_Pointer(wl_client*, wl_resource*, uint32_t);
+			void Get_Keyboard(wl_client*, wl_resource*, uint32_t);
+			void Get_Touch(wl_client*, wl_resource*, uint32_t);
+		}
+
+		namespace WL_Pointer
+		{
+			void Set_Cursor(wl_client*, wl_resource*, uint32_t, wl_resource*, int32_t, int32_t);
+			void Free(wl_resource*);
+		}
+
+		namespace WP_Cursor_Shape_Device_V1
+		{
+			void Set_Shape(wl_client*, wl_resource*, uint32_t, uint32_t);
+		}
+
+		namespace WL_Keyboard
+		{
+			void Free(wl_resource*);
+		}
+
+		namespace WL_Touch
+		{
+			void Free(wl_resource*);
+		}
+
+		namespace Loop
+		{
+			int Wake  (int, uint32_t, void*);
+			int VBlank(int, uint32_t, void*);
+		}
+	}
+
+	// A wl_buffer the compositor holds on to, forgotten if the client destroys it first
+	struct BufferRef
+	{
+		wl_listener  destroy  {}     ; // must stay first, the notify casts back to BufferRef
+		wl_resource* resource = nullptr;
+
+		void Set  (wl_resource* resource);
+		void Clear(                     );
+	};
+
+	struct Surface
+	{
+		Compositor * compositor  = nullptr;
+		wl_resource* resource    = nullptr;
+		wl_resource* xdg_surface = nullptr;
+		wl_resource* toplevel    = nullptr;
+		wl_resource* decoration  = nullptr;
+
+		BufferRef pending          ; // attached, not yet committed
+		bool      attached = false ;
+		BufferRef buffer           ; // committed, released once the next refresh samples it
+		uint64_t  committed = 0    ; // when buffer was committed, CLOCK_MONOTONIC ns
+
+		std::vector<wl_resource*> pending_frames  ; // frame callbacks waiting for a commit
+		std::vector<wl_resource*> frames          ; // committed, fired on the next refresh
+		std::vector<wl_resource*> pending_feedback; // wp_presentation_feedback waiting for a commit
+		std::vector<wl_resource*> feedback        ; // committed, presented on the next refresh
+
+		bool     configured    = false; // the initial configure has been sent
+		bool     entered       = false; // wl_surface.enter has been sent for the output
+		int32_t  pending_scale = 1    ; // wl_surface.set_buffer_scale, applied on commit
+		int32_t  scale         = 1    ; // of buffer
+		int      width         = 0    ; // of the last sampled buffer
+		int      height        = 0    ;
+		uint32_t format        = 0    ;
+	};
+
+	// A compositor that never draws anything. It runs libwayland-server on
+	// its own thread and exports WAYLAND_DISPLAY, so clients in the same
+	// process, or programs it starts, connect to it exactly as they would to
+	// a real display server. Committed buffers are sampled and released on a
+	// virtual refresh, and configure and pointer events can be injected from
+	// any thread.
+	class Compositor
+	{
+	public:
+		struct Stats
+		{
+			uint64_t frames    = 0; // refreshes
+			uint64_t commits   = 0;
+			uint64_t releases  = 0; // buffers handed back to clients
+			uint64_t cursors   = 0; // wl_pointer.set_cursor with a surface
+			uint64_t shapes    = 0; // wp_cursor_shape_device_v1.set_shape
+			uint64_t presented = 0; // wp_presentation_feedback.presented
+			uint64_t discarded = 0; // feedback for commits replaced before a refresh
+			uint64_t enters    = 0; // wl_surface.enter sent
+			uint64_t scale     = 0; // of the last toplevel buffer sampled, 0 until one is
+
+			uint64_t release_latency_total = 0; // commit to release, ns summed over releases
+			uint64_t release_latency_max   = 0;
+		};
+
+	private:
+		wl_display     * display       = nullptr;
+		wl_event_loop  * loop          = nullptr;
+		wl_event_source* wake_source   = nullptr;
+		wl_event_source* vblank_source = nullptr;
+		int              wake_fd       = -1     ;
+		int              vblank_fd     = -1     ;
+
+		std::thread                        thread  ;
+		std::mutex                         mutex   ;
+		std::vector<std::function<void()>> commands; // run on the compositor thread
+		bool                               running = false;
+
+		std::string socket          ;
+		uint32_t    refresh = 60000 ; // mHz, 0 presents on every commit
+		uint64_t    frame   = 0     ; // virtual refreshes so far
+		int         width   = 0     ; // configured toplevel size, 0 lets the client pick
+		int         height  = 0     ;
+		bool        shapes_offered = false; // wp_cursor_shape_manager_v1
+		int32_t     output_scale   = 1    ; // of the one wl_output
+
+		std::vector<uint32_t> states = { XDG_TOPLEVEL_STATE_ACTIVATED }; // sent with every configure
+
+		std::vector<Surface*    > surfaces ;
+		std::vector<wl_resource*> outputs  ; // every client's wl_output
+		std::vector<wl_resource*> pointers ;
+		std::vector<wl_global*  > seats    ; // added after Start, newest last
+		std::vector<wl_resource*> keyboards;
+		Surface*                  keyboard_focus = nullptr;
+		int                       keymap_fd      = -1     ; // a memfd with an xkb keymap, sent to every keyboard
+		uint32_t                  keymap_size    = 0      ;
+		std::vector<wl_resource*> touches  ;
+		Surface*                  touch_focus    = nullptr; // the surface contacts went down on
+		Surface*                  focus    = nullptr; // the surface pointer events go to
+		double                    pointer_x = 0     ;
+		double                    pointer_y = 0     ;
+
+		std::atomic<uint64_t> frames    = 0;
+		std::atomic<uint64_t> commits   = 0;
+		std::atomic<uint64_t> releases  = 0;
+		std::atomic<uint64_t> cursors   = 0;
+		std::atomic<uint64_t> shapes    = 0;
+		std::atomic<uint64_t> presented = 0;
+		std::atomic<uint64_t> discarded = 0;
+		std::atomic<uint64_t> enters    = 0;
+		std::atomic<uint64_t> scale     = 0;
+
+		std::atomic<uint64_t> release_latency_total = 0;
+		std::atomic<uint64_t> release_latency_max   = 0;
+
+		void                      post          (std::function<void()> command);
+		void                      arm           (                             ); // the vblank timer, from refresh
+		void                      present       (Surface& surface, uint32_t time);
+		void                      release       (Surface& surface             );
+		void                      configure     (Surface& surface             );
+		void                      send_output   (wl_resource* output          ); // mode, scale and done
+		void                      pointer_frame (wl_resource* pointer         );
+		std::vector<wl_resource*> focus_pointers(                             );
+		std::vector<wl_resource*> focus_keyboards(                            );
+		std::vector<wl_resource*> focus_touches (                             );
+		uint32_t                  now           (                             ); // ms, for event timestamps
+		uint64_t                  now_ns        (                             );
+
+	public:
+		friend void Functions::WL_Compositor::Create_Surface(wl_client*, wl_resource*, uint32_t);
+		friend void Functions::WL_Surface   ::Commit(wl_client*, wl_resource*);
+		friend void Functions::WL_Surface   ::Free(wl_resource*);
+		friend void Functions::WL_Output    ::Bind(wl_client*, void*, uint32_t, uint32_t);
+		friend void Functions::WL_Output    ::Free(wl_resource*);
+		friend void Functions::WL_Seat      ::Get_Pointer(wl_client*, wl_resource*, uint32_t);
+		friend void Functions::WL_Seat      ::Get_Keyboard(wl_client*, wl_resource*, uint32_t);
+		friend void Functions::WL_Seat      ::Get_Touch(wl_client*, wl_resource*, uint32_t);
+		friend void Functions::WL_Pointer   ::Set_Cursor(wl_client*, wl_resource*, uint32_t, wl_resource*, int32_t, int32_t);
+		friend void Functions::WL_Pointer   ::Free(wl_resource*);
+		friend void Functions::WP_Cursor_Shape_Device_V1::Set_Shape(wl_client*, wl_resource*, uint32_t, uint32_t);
+		friend void Functions::WL_Keyboard  ::Free(wl_resource*);
+		friend void Functions::WL_Touch     ::Free(wl_resource*);
+		friend int  Functions::Loop         ::Wake(int, uint32_t, void*);
+		friend int  Functions::Loop         ::VBlank(int, uint32_t, void*);
+
+		~Compositor();
+
+		void        Start          (uint32_t refresh = 60000); // also exports WAYLAND_DISPLAY
+		void        Stop           (                        );
+		const char* Socket         (                        );
+		Stats       GetStats       (                        );
+		void        SetCursorShapes(bool enabled            ); // before Start, offer wp_cursor_shape_manager_v1
+		void        SetOutputScale (int32_t scale           ); // before Start, of the output every toplevel is on
+
+		// Queued and sent from the compositor thread, safe to call from anywhere
+		void SetRefresh   (uint32_t refresh                   ); // mHz, 0 presents on every commit
+		void Close        (                                   ); // xdg_toplevel.close to every toplevel
+		void PointerEnter (double x, double y                 ); // on the newest toplevel
+		void PointerLeave (                                   );
+		void PointerMotion(double x, double y                 );
+		void PointerButton(uint32_t button, bool pressed      ); // a linux/input-event-codes.h button
+		void PointerAxis  (uint32_t axis, double value        ); // a wl_pointer_axis
+		void KeyboardEnter(                                   ); // on the newest toplevel
+		void Key          (uint32_t key, bool pressed         ); // a linux/input-event-codes.h key
+		void Modifiers    (uint32_t depressed, uint32_t locked); // xkb masks, 1 is Shift and 2 Caps Lock in the keymap sent
+		void TouchDown    (int32_t id, double x, double y     ); // on the newest toplevel, unless contacts are already down
+		void TouchMotion  (int32_t id, double x, double y     );
+		void TouchUp      (int32_t id                         );
+		void TouchFrame   (                                   ); // ends what was sent since the last one
+		void AddSeat      (                                   ); // another seat global, like a hotplugged one
+		void RemoveSeat   (                                   ); // the newest added, with global_remove
+
+		// Every toplevel, and the ones created later. Clients that only follow
+		// interactive resizes need XDG_TOPLEVEL_STATE_RESIZING in states.
+		void Configure(int width, int height, std::vector<uint32_t> states = { XDG_TOPLEVEL_STATE_ACTIVATED });
+	};
+}
@@ -0,0 +1,198 @@
+#include "Compositor.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <linux/input-event-codes.h>
+
+#include <fmt/format.h>
+
+Headless::Compositor compositor;
+
+static int usage()
+{
+	std::cerr << "usage: headless-test [--refresh mHz] [--scale N] [--size WxH] [--timeout seconds] [--pointer] [--keyboard] [--touch] [--cursor-shape] [--resize] [--hotplug] program [args...]\n";
+	return 2;
+}
+
+// Runs a client against the headless compositor, e.g. `headless-test --timeout 5 ./build/shm-test`
+int main(int argc, char** argv)
+{
+	uint32_t refresh  = 60000;
+	int32_t  scale    = 1    ; // of the output
+	int      width    = 0    ;
+	int      height   = 0    ;
+	double   timeout  = 0    ; // seconds, 0 waits for the client to exit by itself
+	bool     pointer  = false; // move and click a pointer over the window the whole time
+	bool     keyboard = false; // keep typing into the window
+	bool     touch    = false; // keep putting ten fingers on the window
+	bool     shapes   = false; // offer wp_cursor_shape_manager_v1
+	bool     resize   = false; // keep resizing the window interactively
+	bool     hotplug  = false; // keep adding and removing a second seat
+
+	int a = 1;
+	for (; a < argc && argv[a][0] == '-'; a++)
+	{
+		bool* flag = !strcmp(argv[a], "--pointer"     ) ? &pointer  :
+		             !strcmp(argv[a], "--keyboard"    ) ? &keyboard :
+		             !strcmp(argv[a], "--touch"       ) ? &touch    :
+		             !strcmp(argv[a], "--cursor-shape") ? &shapes   :
+		             !strcmp(argv[a], "--resize"      ) ? &resize   :
+		             !strcmp(argv[a], "--hotplug"     ) ? &hotplug  : nullptr;
+		if (flag)
+		{
+			*flag = true;
+			continue;
+		}
+
+		if (a + 1 == argc)
+			return usage();
+
+		if      (!strcmp(argv[a], "--refresh")) refresh = strtoul(argv[++a], nullptr, 10);
+		else if (!strcmp(argv[a], "--scale"  )) scale   = strtol (argv[++a], nullptr, 10);
+		else if (!strcmp(argv[a], "--timeout")) timeout = strtod(argv[++a], nullptr);
+		else if (!strcmp(argv[a], "--size"   ))
+		{
+			if (sscanf(argv[++a], "%dx%d", &width, &height) != 2)
+				return usage();
+		}
+		else
+			return usage();
+	}
+
+	if (a == argc)
+		return usage();
+
+	compositor.SetCursorShapes(shapes);
+	compositor.SetOutputScale(scale);
+	compositor.Start(refresh);
+	if (width && height)
+		compositor.Configure(width, height);
+
+	pid_t child = fork();
+	if (child < 0)
+		throw std::runtime_error(fmt::format("Could not start {}: {}", argv[a], strerror(errno)));
+
+	if (child == 0)
+	{
+		execvp(argv[a], argv + a);
+		_exit(127);
+	}
+
+	auto start  = std::chrono::steady_clock::now();
+	bool closed = false;
+	int  status = 0;
+	int  tick   = 0;
+
+	// Ask nicely first, a client that ignores xdg_toplevel.close gets a second to go
+	while (waitpid(child, &status, WNOHANG) == 0)
+	{
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (timeout > 0 && !closed && elapsed > timeout)
+		{
+			compositor.Close();
+			closed = true;
+		}
+
+		if (closed && elapsed > timeout + 1)
+			kill(child, SIGTERM);
+
+		// Enters once the client has had time to map its window, then
+		// circles over it with a right click every second
+		if (pointer && !closed && tick >= 10)
+		{
+			if (tick == 10)
+				compositor.PointerEnter(100, 100);
+
+			compositor.PointerMotion(100 + 50 * cos(tick / 10.0), 100 + 50 * sin(tick / 10.0));
+			if (tick % 100 == 0)
+				compositor.PointerButton(BTN_RIGHT, true);
+			if (tick % 100 == 1)
+				compositor.PointerButton(BTN_RIGHT, false);
+		}
+
+		// Types a capital H and an i every two seconds, then holds a long
+		// enough for it to repeat
+		if (keyboard && !closed && tick >= 10)
+		{
+			int phase = tick % 200;
+
+			if (tick == 10)
+				compositor.KeyboardEnter();
+
+			if (phase == 20)
+			{
+				compositor.Key(KEY_LEFTSHIFT, true);
+				compositor.Modifiers(1, 0);
+			}
+			if (phase == 22 ) compositor.Key(KEY_H, true );
+			if (phase == 24 ) compositor.Key(KEY_H, false);
+			if (phase == 26)
+			{
+				compositor.Key(KEY_LEFTSHIFT, false);
+				compositor.Modifiers(0, 0);
+			}
+			if (phase == 30 ) compositor.Key(KEY_I, true );
+			if (phase == 32 ) compositor.Key(KEY_I, false);
+			if (phase == 60 ) compositor.Key(KEY_A, true );
+			if (phase == 160) compositor.Key(KEY_A, false);
+		}
+
+		// Ten fingers go down together every two seconds, spin around for a
+		// second and lift one at a time
+		if (touch && !closed && tick >= 10)
+		{
+			int phase = tick % 200;
+
+			for (int32_t finger = 0; finger < 10; finger++)
+			{
+				double angle = finger * M_PI / 5 + tick / 10.0;
+				double x     = 150 + 60 * cos(angle);
+				double y     = 150 + 60 * sin(angle);
+
+				if      (phase == 20                ) compositor.TouchDown  (finger, x, y);
+				else if (phase >  20 && phase <  120) compositor.TouchMotion(finger, x, y);
+				else if (phase == 120 + finger      ) compositor.TouchUp    (finger);
+			}
+
+			if (phase >= 20 && phase < 130)
+				compositor.TouchFrame();
+		}
+
+		if (resize && !closed && tick % 10 == 0)
+			compositor.Configure(320 + tick % 320, 200 + tick % 200, { XDG_TOPLEVEL_STATE_ACTIVATED, XDG_TOPLEVEL_STATE_RESIZING });
+
+		// A second seat is plugged in for a second out of every two
+		if (hotplug && !closed && tick % 200 == 50)
+			compositor.AddSeat();
+		if (hotplug && !closed && tick % 200 == 150)
+			compositor.RemoveSeat();
+
+		tick++;
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	Headless::Compositor::Stats stats = compositor.GetStats();
+	double latency = stats.releases ? stats.release_latency_total / 1e6 / stats.releases : 0;
+
+	std::cout << fmt::format("headless: {} frames, {} commits, {} releases, {:.3f}ms mean / {:.3f}ms max commit to release\n", stats.frames, stats.commits, stats.releases, latency, stats.release_latency_max / 1e6);
+	if (stats.cursors || stats.shapes)
+		std::cout << fmt::format("headless: {} cursor surfaces and {} cursor shapes set\n", stats.cursors, stats.shapes);
+	if (stats.presented || stats.discarded)
+		std::cout << fmt::format("headless: {} commits presented and {} discarded with feedback\n", stats.presented, stats.discarded);
+	if (stats.enters)
+		std::cout << fmt::format("headless: {} surfaces entered the {}x output, the last toplevel buffer was {}x\n", stats.enters, scale, stats.scale);
+
+	compositor.Stop();
+
+	return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
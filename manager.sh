@@ -44,12 +44,22 @@ elif [ "$1" == "SHM" ]; then
 				echo Building object files
 				g++ -std=c++2a -Wall -g -I ./shm -c -o build/shm/main.cpp.obj shm/main.cpp
 				g++ -std=c++2a -Wall -g -I ./shm -c -o build/shm/Wayland.cpp.obj shm/Wayland.cpp
+				g++ -std=c++2a -Wall -g -I ./shm -c -o build/shm/EventLoop.cpp.obj shm/EventLoop.cpp
+				g++ -std=c++2a -Wall -g -I ./shm -c -o build/shm/Log.cpp.obj shm/Log.cpp
+				g++ -std=c++2a -Wall -g -I ./shm -c -o build/shm/Allocations.cpp.obj shm/Allocations.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/shm/Fill.cpp.obj shm/Fill.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/shm/Convert.cpp.obj shm/Convert.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/shm/Workers.cpp.obj shm/Workers.cpp
+				g++ -std=c++2a -Wall -g -I ./shm -c -o build/shm/Swapchain.cpp.obj shm/Swapchain.cpp
+				g++ -std=c++2a -Wall -g -I ./shm -c -o build/shm/SharedMemory.cpp.obj shm/SharedMemory.cpp
+				g++ -std=c++2a -Wall -g -I ./shm -c -o build/shm/Pool.cpp.obj shm/Pool.cpp
+				g++ -std=c++2a -Wall -g -I ./shm -c -o build/shm/Region.cpp.obj shm/Region.cpp
 				g++ -std=c++2a -Wall -g -I ./shm -c -o build/shm/format.cc.obj shm/fmt/format.cc
 				gcc -Wall -g -I ./shm -c -o build/shm/xdg-shell-protocol.c.obj shm/xdg-shell-protocol.c 
 				gcc -Wall -g -I ./shm -c -o build/shm/xdg-decoration-protocol.c.obj shm/xdg-decoration-protocol.c
 
 				echo Linking exe
-				g++ -std=c++2a -Wall -lwayland-client -g -I ./ -o build/shm-test build/shm/*
+				g++ -std=c++2a -Wall -pthread -lwayland-client -g -I ./ -o build/shm-test build/shm/*
 			;;
 			"run")
 				echo Running
@@ -79,12 +89,13 @@ elif [ "$1" == "EGL" ]; then
 				echo Building object files
 				g++ -std=c++2a -Wall -g -I ./egl -c -o build/egl/main.cpp.obj egl/main.cpp
 				g++ -std=c++2a -Wall -g -I ./egl -c -o build/egl/Wayland.cpp.obj egl/Wayland.cpp
+				g++ -std=c++2a -Wall -g -I ./egl -c -o build/egl/Log.cpp.obj egl/Log.cpp
 				g++ -std=c++2a -Wall -g -I ./egl -c -o build/egl/format.cc.obj egl/fmt/format.cc
 				gcc -Wall -g -I ./egl -c -o build/egl/xdg-shell-protocol.c.obj egl/xdg-shell-protocol.c 
 				gcc -Wall -g -I ./egl -c -o build/egl/xdg-decoration-protocol.c.obj egl/xdg-decoration-protocol.c
 
 				echo Linking exe
-				g++ -std=c++2a -Wall -g -I ./ -o build/egl-test build/egl/* -lwayland-client -lEGL -lwayland-egl -lGLESv2
+				g++ -std=c++2a -Wall -pthread -g -I ./ -o build/egl-test build/egl/* -lwayland-client -lEGL -lwayland-egl -lGLESv2
 			;;
 			"run")
 				echo Running
@@ -106,6 +117,11 @@ elif [ "$1" == "Pointer" ]; then
 				wayland-scanner private-code /usr/share/wayland-protocols/stable/xdg-shell/xdg-shell.xml pointer/xdg-shell-protocol.c
 				wayland-scanner client-header /usr/share/wayland-protocols/unstable/xdg-decoration/xdg-decoration-unstable-v1.xml pointer/xdg-decoration-protocol.h
 				wayland-scanner private-code /usr/share/wayland-protocols/unstable/xdg-decoration/xdg-decoration-unstable-v1.xml pointer/xdg-decoration-protocol.c
+				wayland-scanner client-header /usr/share/wayland-protocols/staging/cursor-shape/cursor-shape-v1.xml pointer/cursor-shape-v1-client-protocol.h
+				wayland-scanner private-code /usr/share/wayland-protocols/staging/cursor-shape/cursor-shape-v1.xml pointer/cursor-shape-v1-protocol.c
+				wayland-scanner private-code /usr/share/wayland-protocols/unstable/tablet/tablet-unstable-v2.xml pointer/tablet-unstable-v2-protocol.c
+				wayland-scanner client-header /usr/share/wayland-protocols/stable/presentation-time/presentation-time.xml pointer/presentation-time-client-protocol.h
+				wayland-scanner private-code /usr/share/wayland-protocols/stable/presentation-time/presentation-time.xml pointer/presentation-time-protocol.c
 			;;
 			"build")
 				rm -rf build/pointer
@@ -114,12 +130,31 @@ elif [ "$1" == "Pointer" ]; then
 				echo Building object files
 				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/main.cpp.obj pointer/main.cpp
 				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/Wayland.cpp.obj pointer/Wayland.cpp
+				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/EventLoop.cpp.obj pointer/EventLoop.cpp
+				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/Input.cpp.obj pointer/Input.cpp
+				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/Seats.cpp.obj pointer/Seats.cpp
+				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/Outputs.cpp.obj pointer/Outputs.cpp
+				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/Keymap.cpp.obj pointer/Keymap.cpp
+				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/Cursors.cpp.obj pointer/Cursors.cpp
+				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/Presentation.cpp.obj pointer/Presentation.cpp
+				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/Scheduler.cpp.obj pointer/Scheduler.cpp
+				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/SharedMemory.cpp.obj pointer/SharedMemory.cpp
+				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/Pool.cpp.obj pointer/Pool.cpp
+				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/Swapchain.cpp.obj pointer/Swapchain.cpp
+				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/Region.cpp.obj pointer/Region.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./pointer -c -o build/pointer/Convert.cpp.obj pointer/Convert.cpp
+				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/Log.cpp.obj pointer/Log.cpp
+				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/Allocations.cpp.obj pointer/Allocations.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./pointer -c -o build/pointer/Fill.cpp.obj pointer/Fill.cpp
 				g++ -std=c++2a -Wall -g -I ./pointer -c -o build/pointer/format.cc.obj pointer/fmt/format.cc
 				gcc -Wall -g -I ./pointer -c -o build/pointer/xdg-shell-protocol.c.obj pointer/xdg-shell-protocol.c 
 				gcc -Wall -g -I ./pointer -c -o build/pointer/xdg-decoration-protocol.c.obj pointer/xdg-decoration-protocol.c
+				gcc -Wall -g -I ./pointer -c -o build/pointer/cursor-shape-v1-protocol.c.obj pointer/cursor-shape-v1-protocol.c
+				gcc -Wall -g -I ./pointer -c -o build/pointer/tablet-unstable-v2-protocol.c.obj pointer/tablet-unstable-v2-protocol.c
+				gcc -Wall -g -I ./pointer -c -o build/pointer/presentation-time-protocol.c.obj pointer/presentation-time-protocol.c
 
 				echo Linking exe
-				g++ -std=c++2a -Wall -lwayland-client -g -I ./ -o build/pointer-test build/pointer/*
+				g++ -std=c++2a -Wall -pthread -lwayland-client -lwayland-cursor -lxkbcommon -g -I ./ -o build/pointer-test build/pointer/*
 			;;
 			"run")
 				echo Running
@@ -132,4 +167,116 @@ elif [ "$1" == "Pointer" ]; then
 	    esac
 	    shift
 	done
+elif [ "$1" == "Headless" ]; then
+	shift
+	while [ "$1" != "" ]; do
+		case $1 in
+			"wayland")
+				wayland-scanner server-header /usr/share/wayland-protocols/stable/xdg-shell/xdg-shell.xml headless/xdg-shell-server-protocol.h
+				wayland-scanner server-header /usr/share/wayland-protocols/unstable/xdg-decoration/xdg-decoration-unstable-v1.xml headless/xdg-decoration-server-protocol.h
+				wayland-scanner server-header /usr/share/wayland-protocols/staging/cursor-shape/cursor-shape-v1.xml headless/cursor-shape-v1-server-protocol.h
+				wayland-scanner server-header /usr/share/wayland-protocols/stable/presentation-time/presentation-time.xml headless/presentation-time-server-protocol.h
+			;;
+			"build")
+				rm -rf build/headless
+				mkdir -p build/headless
+
+				echo Building object files
+				g++ -std=c++2a -Wall -g -I ./headless -I ./shm -c -o build/headless/main.cpp.obj headless/main.cpp
+				g++ -std=c++2a -Wall -g -I ./headless -I ./shm -c -o build/headless/Compositor.cpp.obj headless/Compositor.cpp
+				g++ -std=c++2a -Wall -g -I ./shm -c -o build/headless/format.cc.obj shm/fmt/format.cc
+				gcc -Wall -g -I ./shm -c -o build/headless/xdg-shell-protocol.c.obj shm/xdg-shell-protocol.c
+				gcc -Wall -g -I ./shm -c -o build/headless/xdg-decoration-protocol.c.obj shm/xdg-decoration-protocol.c
+				gcc -Wall -g -I ./pointer -c -o build/headless/cursor-shape-v1-protocol.c.obj pointer/cursor-shape-v1-protocol.c
+				gcc -Wall -g -I ./pointer -c -o build/headless/tablet-unstable-v2-protocol.c.obj pointer/tablet-unstable-v2-protocol.c
+				gcc -Wall -g -I ./pointer -c -o build/headless/presentation-time-protocol.c.obj pointer/presentation-time-protocol.c
+
+				echo Linking exe
+				g++ -std=c++2a -Wall -pthread -g -o build/headless-test build/headless/* -lwayland-server
+			;;
+			"run")
+				echo Running
+				./build/headless-test --timeout 5 ./build/shm-test
+			;;
+			"check")
+				# Every source built with the allocation counter and all logging
+				# on; Dispatch throws, failing the run, if a callback allocates
+				for module in shm pointer; do
+					rm -rf build/check/$module
+					mkdir -p build/check/$module
+
+					echo Building $module with allocation checks
+					for source in $module/*.cpp $module/fmt/format.cc; do
+						g++ -std=c++2a -Wall -g -DWAYLAND_COUNT_ALLOCATIONS -DWAYLAND_LOG_LEVEL=0 -I ./$module -c -o build/check/$module/$(basename $source).obj $source
+					done
+					for source in $module/*.c; do
+						gcc -Wall -g -I ./$module -c -o build/check/$module/$(basename $source).obj $source
+					done
+
+					libs=-lwayland-client
+					[ $module = pointer ] && libs="$libs -lwayland-cursor -lxkbcommon"
+
+					g++ -std=c++2a -Wall -pthread -g -o build/check/$module-test build/check/$module/* $libs
+				done
+
+				echo Checking
+				./build/headless-test --timeout 3 --resize ./build/check/shm-test > /dev/null && echo shm: no allocations
+				./build/headless-test --timeout 3 --pointer --keyboard --touch --resize ./build/check/pointer-test > /dev/null && echo pointer: no allocations
+				./build/headless-test --timeout 3 --pointer --cursor-shape ./build/check/pointer-test > /dev/null && echo pointer with cursor shapes: no allocations
+			;;
+	    esac
+	    shift
+	done
+elif [ "$1" == "Bench" ]; then
+	shift
+	while [ "$1" != "" ]; do
+		case $1 in
+			"build")
+				rm -rf build/bench
+				mkdir -p build/bench
+
+				echo Building object files
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/fill.cpp.obj bench/fill.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/Fill.cpp.obj shm/Fill.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/Convert.cpp.obj shm/Convert.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/format.cc.obj shm/fmt/format.cc
+
+				echo Linking exe
+				g++ -std=c++2a -Wall -g -O2 -o build/bench-fill build/bench/fill.cpp.obj build/bench/Fill.cpp.obj build/bench/Convert.cpp.obj build/bench/format.cc.obj
+
+				mkdir -p build/bench/frame
+
+				echo Building frame object files
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -I ./headless -c -o build/bench/frame/frame.cpp.obj bench/frame.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -I ./headless -c -o build/bench/frame/Compositor.cpp.obj headless/Compositor.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/frame/Wayland.cpp.obj shm/Wayland.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/frame/EventLoop.cpp.obj shm/EventLoop.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/frame/Log.cpp.obj shm/Log.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/frame/Allocations.cpp.obj shm/Allocations.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/frame/Fill.cpp.obj shm/Fill.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/frame/Convert.cpp.obj shm/Convert.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/frame/Workers.cpp.obj shm/Workers.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/frame/Swapchain.cpp.obj shm/Swapchain.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/frame/SharedMemory.cpp.obj shm/SharedMemory.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/frame/Pool.cpp.obj shm/Pool.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/frame/Region.cpp.obj shm/Region.cpp
+				g++ -std=c++2a -Wall -g -O2 -I ./shm -c -o build/bench/frame/format.cc.obj shm/fmt/format.cc
+				gcc -Wall -g -I ./shm -c -o build/bench/frame/xdg-shell-protocol.c.obj shm/xdg-shell-protocol.c
+				gcc -Wall -g -I ./shm -c -o build/bench/frame/xdg-decoration-protocol.c.obj shm/xdg-decoration-protocol.c
+				gcc -Wall -g -I ./pointer -c -o build/bench/frame/cursor-shape-v1-protocol.c.obj pointer/cursor-shape-v1-protocol.c
+				gcc -Wall -g -I ./pointer -c -o build/bench/frame/tablet-unstable-v2-protocol.c.obj pointer/tablet-unstable-v2-protocol.c
+				gcc -Wall -g -I ./pointer -c -o build/bench/frame/presentation-time-protocol.c.obj pointer/presentation-time-protocol.c
+
+				echo Linking frame exe
+				g++ -std=c++2a -Wall -g -O2 -pthread -o build/bench-frame build/bench/frame/* -lwayland-client -lwayland-server
+			;;
+			"run")
+				echo Running
+				./build/bench-fill
+				./build/bench-frame build/bench.json
+				cat build/bench.json
+			;;
+	    esac
+	    shift
+	done
 fi
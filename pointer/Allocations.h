@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Wayland
+{
+	// Counts operator new calls per thread, to prove that dispatching events
+	// never allocates. Built with -DWAYLAND_COUNT_ALLOCATIONS this replaces
+	// the global operator new, and EventLoop::Dispatch throws when a callback
+	// it ran allocated. Otherwise Count is always 0 and nothing is checked.
+	// libwayland's own mallocs (closures, proxies) are not counted.
+	namespace Allocations
+	{
+		uint64_t Count   (                                 ); // so far on the calling thread
+		void     Check   (bool enabled                     ); // on by default when counting
+		void     Expect  (uint64_t before, const char* what); // throws if the thread allocated since before
+	}
+}
@@ -0,0 +1,225 @@
+#include "Convert.h"
+#include "Fill.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CONVERT_X86
+#include <immintrin.h>
+#endif
+
+namespace Wayland
+{
+	namespace Convert
+	{
+		static uint16_t to_rgb565(uint32_t pixel)
+		{
+			return ((pixel >> 8) & 0xF800) | ((pixel >> 5) & 0x07E0) | ((pixel >> 3) & 0x001F);
+		}
+
+		// 8 to 10 bits by repeating the top bits, so 0xFF becomes 0x3FF
+		static uint32_t to_xrgb2101010(uint32_t pixel)
+		{
+			uint32_t b = pixel & 0xFF, g = (pixel >> 8) & 0xFF, r = (pixel >> 16) & 0xFF;
+
+			b = (b << 2) | (b >> 6);
+			g = (g << 2) | (g >> 6);
+			r = (r << 2) | (r >> 6);
+
+			return 0xC0000000 | r << 20 | g << 10 | b;
+		}
+
+		namespace Scalar
+		{
+			static void rgb565(const uint32_t* source, uint16_t* destination, int count)
+			{
+				for (int a = 0; a < count; a++)
+					destination[a] = to_rgb565(source[a]);
+			}
+
+			static void xrgb2101010(const uint32_t* source, uint32_t* destination, int count)
+			{
+				for (int a = 0; a < count; a++)
+					destination[a] = to_xrgb2101010(source[a]);
+			}
+		}
+
+#ifdef CONVERT_X86
+		namespace SSE2
+		{
+			__attribute__((target("sse2")))
+			static __m128i rgb565_lanes(__m128i pixel)
+			{
+				__m128i r = _mm_and_si128(_mm_srli_epi32(pixel, 8), _mm_set1_epi32(0xF800));
+				__m128i g = _mm_and_si128(_mm_srli_epi32(pixel, 5), _mm_set1_epi32(0x07E0));
+				__m128i b = _mm_and_si128(_mm_srli_epi32(pixel, 3), _mm_set1_epi32(0x001F));
+
+				// Sign extend so the signed saturating pack keeps all 16 bits
+				__m128i value = _mm_or_si128(_mm_or_si128(r, g), b);
+				return _mm_srai_epi32(_mm_slli_epi32(value, 16), 16);
+			}
+
+			__attribute__((target("sse2")))
+			static void rgb565(const uint32_t* source, uint16_t* destination, int count)
+			{
+				int a = 0;
+				for (; a + 8 <= count; a += 8)
+				{
+					__m128i low  = rgb565_lanes(_mm_loadu_si128((const __m128i*)(source + a    )));
+					__m128i high = rgb565_lanes(_mm_loadu_si128((const __m128i*)(source + a + 4)));
+
+					_mm_storeu_si128((__m128i*)(destination + a), _mm_packs_epi32(low, high));
+				}
+				for (; a < count; a++)
+					destination[a] = to_rgb565(source[a]);
+			}
+
+			__attribute__((target("sse2")))
+			static __m128i expand(__m128i channel)
+			{
+				return _mm_or_si128(_mm_slli_epi32(channel, 2), _mm_srli_epi32(channel, 6));
+			}
+
+			__attribute__((target("sse2")))
+			static void xrgb2101010(const uint32_t* source, uint32_t* destination, int count)
+			{
+				const __m128i mask = _mm_set1_epi32(0xFF);
+				const __m128i x    = _mm_set1_epi32(0xC0000000);
+
+				int a = 0;
+				for (; a + 4 <= count; a += 4)
+				{
+					__m128i pixel = _mm_loadu_si128((const __m128i*)(source + a));
+
+					__m128i b = expand(_mm_and_si128(pixel                    , mask));
+					__m128i g = expand(_mm_and_si128(_mm_srli_epi32(pixel,  8), mask));
+					__m128i r = expand(_mm_and_si128(_mm_srli_epi32(pixel, 16), mask));
+
+					__m128i value = _mm_or_si128(_mm_or_si128(x, _mm_slli_epi32(r, 20)), _mm_or_si128(_mm_slli_epi32(g, 10), b));
+					_mm_storeu_si128((__m128i*)(destination + a), value);
+				}
+				for (; a < count; a++)
+					destination[a] = to_xrgb2101010(source[a]);
+			}
+		}
+
+		namespace AVX2
+		{
+			__attribute__((target("avx2")))
+			static __m256i rgb565_lanes(__m256i pixel)
+			{
+				__m256i r = _mm256_and_si256(_mm256_srli_epi32(pixel, 8), _mm256_set1_epi32(0xF800));
+				__m256i g = _mm256_and_si256(_mm256_srli_epi32(pixel, 5), _mm256_set1_epi32(0x07E0));
+				__m256i b = _mm256_and_si256(_mm256_srli_epi32(pixel, 3), _mm256_set1_epi32(0x001F));
+
+				__m256i value = _mm256_or_si256(_mm256_or_si256(r, g), b);
+				return _mm256_srai_epi32(_mm256_slli_epi32(value, 16), 16);
+			}
+
+			__attribute__((target("avx2")))
+			static void rgb565(const uint32_t* source, uint16_t* destination, int count)
+			{
+				int a = 0;
+				for (; a + 16 <= count; a += 16)
+				{
+					__m256i low  = rgb565_lanes(_mm256_loadu_si256((const __m256i*)(source + a    )));
+					__m256i high = rgb565_lanes(_mm256_loadu_si256((const __m256i*)(source + a + 8)));
+
+					// The pack works within 128-bit lanes, put the quarters back in order
+					__m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), 0xD8);
+					_mm256_storeu_si256((__m256i*)(destination + a), packed);
+				}
+				for (; a < count; a++)
+					destination[a] = to_rgb565(source[a]);
+			}
+
+			__attribute__((target("avx2")))
+			static __m256i expand(__m256i channel)
+			{
+				return _mm256_or_si256(_mm256_slli_epi32(channel, 2), _mm256_srli_epi32(channel, 6));
+			}
+
+			__attribute__((target("avx2")))
+			static void xrgb2101010(const uint32_t* source, uint32_t* destination, int count)
+			{
+				const __m256i mask = _mm256_set1_epi32(0xFF);
+				const __m256i x    = _mm256_set1_epi32(0xC0000000);
+
+				int a = 0;
+				for (; a + 8 <= count; a += 8)
+				{
+					__m256i pixel = _mm256_loadu_si256((const __m256i*)(source + a));
+
+					__m256i b = expand(_mm256_and_si256(pixel                       , mask));
+					__m256i g = expand(_mm256_and_si256(_mm256_srli_epi32(pixel,  8), mask));
+					__m256i r = expand(_mm256_and_si256(_mm256_srli_epi32(pixel, 16), mask));
+
+					__m256i value = _mm256_or_si256(_mm256_or_si256(x, _mm256_slli_epi32(r, 20)), _mm256_or_si256(_mm256_slli_epi32(g, 10), b));
+					_mm256_storeu_si256((__m256i*)(destination + a), value);
+				}
+				for (; a < count; a++)
+					destination[a] = to_xrgb2101010(source[a]);
+			}
+		}
+#endif
+
+		int BytesPerPixel(uint32_t format)
+		{
+			switch (format)
+			{
+			case WL_SHM_FORMAT_RGB565: return 2;
+			default                  : return 4;
+			}
+		}
+
+		bool Needed(uint32_t format)
+		{
+			return format == WL_SHM_FORMAT_RGB565 || format == WL_SHM_FORMAT_XRGB2101010;
+		}
+
+		bool HasAlpha(uint32_t format)
+		{
+			return format == WL_SHM_FORMAT_ARGB8888;
+		}
+
+		void ToRGB565(const uint32_t* source, uint16_t* destination, int count)
+		{
+			switch (Fill::Selected())
+			{
+#ifdef CONVERT_X86
+			case Fill::Path::AVX2: AVX2  ::rgb565(source, destination, count); break;
+			case Fill::Path::SSE2: SSE2  ::rgb565(source, destination, count); break;
+#endif
+			default              : Scalar::rgb565(source, destination, count); break;
+			}
+		}
+
+		void ToXRGB2101010(const uint32_t* source, uint32_t* destination, int count)
+		{
+			switch (Fill::Selected())
+			{
+#ifdef CONVERT_X86
+			case Fill::Path::AVX2: AVX2  ::xrgb2101010(source, destination, count); break;
+			case Fill::Path::SSE2: SSE2  ::xrgb2101010(source, destination, count); break;
+#endif
+			default              : Scalar::xrgb2101010(source, destination, count); break;
+			}
+		}
+
+		void Rows(const uint32_t* source, int source_stride, char* destination, int destination_stride, int width, int first, int last, uint32_t format)
+		{
+			for (int y = first; y < last; y++)
+			{
+				const uint32_t* from = (const uint32_t*)((const char*)source + (intptr_t)y * source_stride);
+				char*           to   = destination + (intptr_t)y * destination_stride;
+
+				switch (format)
+				{
+				case WL_SHM_FORMAT_RGB565     : ToRGB565     (from, (uint16_t*)to, width); break;
+				case WL_SHM_FORMAT_XRGB2101010: ToXRGB2101010(from, (uint32_t*)to, width); break;
+				default                       : memcpy(to, from, width * sizeof(uint32_t)); break;
+				}
+			}
+		}
+	}
+}
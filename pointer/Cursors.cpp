@@ -0,0 +1,101 @@
+#include "Cursors.h"
+#include "Log.h"
+
+#include <cstdlib>
+
+namespace Wayland
+{
+	// Freedesktop names first, then the X11 ones older themes still use
+	static constexpr const char* names[Cursors::Shapes][2] =
+	{
+		{ "default"    , "left_ptr"       },
+		{ "pointer"    , "hand2"          },
+		{ "text"       , "xterm"          },
+		{ "wait"       , "watch"          },
+		{ "crosshair"  , "cross"          },
+		{ "move"       , "fleur"          },
+		{ "not-allowed", "crossed_circle" },
+	};
+
+	void Cursors::Init(wl_shm* shm)
+	{
+		this->shm = shm;
+
+		name = getenv("XCURSOR_THEME");
+		if (const char* value = getenv("XCURSOR_SIZE"); value && atoi(value) > 0)
+			size = atoi(value);
+	}
+
+	void Cursors::Destroy()
+	{
+		for (Theme& slot : themes)
+			if (slot.theme)
+				wl_cursor_theme_destroy(slot.theme);
+
+		for (Theme& slot : themes)
+			slot = {};
+	}
+
+	wl_cursor_theme* Cursors::theme(int scale)
+	{
+		Theme* nearest = nullptr;
+
+		for (Theme& slot : themes)
+		{
+			if (slot.scale == scale)
+				return slot.theme;
+
+			if (slot.scale == 0)
+			{
+				// A theme that failed to load stays failed, rather than being retried on every lookup
+				slot.scale = scale;
+				slot.theme = wl_cursor_theme_load(name, size * scale, shm);
+
+				if (slot.theme == nullptr)
+					LOG(Warn, "Could not load the {} cursor theme at {}px", name ? name : "default", size * scale);
+				else
+					LOG(Info, "Loaded the {} cursor theme at {}px", name ? name : "default", size * scale);
+
+				return slot.theme;
+			}
+
+			if (nearest == nullptr || abs(slot.scale - scale) < abs(nearest->scale - scale))
+				nearest = &slot;
+		}
+
+		return nearest->theme;
+	}
+
+	wl_cursor* Cursors::load(Shape shape, int scale)
+	{
+		wl_cursor_theme* loaded = theme(scale);
+		if (loaded == nullptr)
+			return nullptr;
+
+		for (const char* candidate : names[shape])
+		{
+			wl_cursor* cursor = wl_cursor_theme_get_cursor(loaded, candidate);
+			if (cursor == nullptr)
+				continue;
+
+			// Every frame is uploaded now, showing one later only attaches it
+			for (unsigned int a = 0; a < cursor->image_count; a++)
+				wl_cursor_image_get_buffer(cursor->images[a]);
+
+			return cursor;
+		}
+
+		return nullptr;
+	}
+
+	wl_cursor* Cursors::Get(Shape shape, int scale)
+	{
+		// The theme keeps every cursor it decoded and every buffer it created,
+		// so looking one up again is a name search that uploads nothing
+		wl_cursor* cursor = load(shape, scale);
+		if (cursor == nullptr && shape != Default)
+			cursor = load(Default, scale);
+
+		return cursor;
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <wayland-client.h>
+#include <wayland-cursor.h>
+
+namespace Wayland
+{
+	// Every cursor a window shows, shared by all of them. A theme is loaded
+	// once per scale, which decodes all of its images, and each cursor's
+	// buffers are created the first time it is asked for. The theme owns
+	// both and keeps them until it is destroyed, so asking for a cursor
+	// again only attaches buffers the compositor already has.
+	class Cursors
+	{
+	public:
+		// Named for what they mean, themes have their own names for them
+		enum Shape
+		{
+			Default    ,
+			Pointer    , // over something clickable
+			Text       ,
+			Wait       , // usually animated
+			Crosshair  ,
+			Move       ,
+			Not_Allowed,
+			Shapes     ,
+		};
+
+		static constexpr int MaxThemes = 4; // scales, more than this share the nearest one loaded
+
+	private:
+		struct Theme
+		{
+			int              scale = 0      ; // 0 while the slot is free
+			wl_cursor_theme* theme = nullptr;
+		};
+
+		wl_shm*     shm  = nullptr;
+		const char* name = nullptr; // XCURSOR_THEME, nullptr for the default
+		int         size = 24     ; // XCURSOR_SIZE, at scale 1
+		Theme       themes[MaxThemes];
+
+		wl_cursor_theme* theme(int scale); // loads it the first time
+		wl_cursor*       load (Shape shape, int scale);
+
+	public:
+		void       Init   (wl_shm* shm           );
+		void       Destroy(                      ); // once no surface shows a cursor any more
+		wl_cursor* Get    (Shape shape, int scale); // nullptr when the theme has nothing like it
+	};
+}
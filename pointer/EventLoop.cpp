@@ -0,0 +1,216 @@
+#include "EventLoop.h"
+#include "Allocations.h"
+
+#include <cstring>
+
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <errno.h>
+#include <unistd.h>
+
+namespace Wayland
+{
+	static const int MaxEvents = 16;
+
+	static itimerspec to_itimerspec(std::chrono::nanoseconds initial, std::chrono::nanoseconds interval)
+	{
+		auto to_timespec = [](std::chrono::nanoseconds time)
+		{
+			return timespec{ (time_t)(time.count() / 1000000000), (long)(time.count() % 1000000000) };
+		};
+
+		return itimerspec{ to_timespec(interval), to_timespec(initial) };
+	}
+
+	void EventLoop::Init(wl_display* display)
+	{
+		this->display = display;
+
+		epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+		if (epoll_fd < 0)
+			throw std::runtime_error(fmt::format("epoll_create1 failed: {}", strerror(errno)));
+
+		display_fd = wl_display_get_fd(display);
+
+		epoll_event event = {};
+		event.events  = EPOLLIN;
+		event.data.fd = display_fd;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, display_fd, &event) < 0)
+			throw std::runtime_error(fmt::format("Watching the display failed: {}", strerror(errno)));
+
+		watching = EPOLLIN;
+	}
+
+	void EventLoop::Destroy()
+	{
+		for (int fd = 0; fd < (int)sources.size(); fd++)
+			if (sources[fd] && sources[fd]->timer)
+				close(fd);
+
+		sources.clear();
+
+		if (epoll_fd >= 0)
+			close(epoll_fd);
+
+		epoll_fd   = -1;
+		display_fd = -1;
+		display    = nullptr;
+	}
+
+	bool EventLoop::Watch(uint32_t events)
+	{
+		if (events == watching)
+			return true;
+
+		epoll_event event = {};
+		event.events  = events;
+		event.data.fd = display_fd;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, display_fd, &event) < 0)
+			return false;
+
+		watching = events;
+		return true;
+	}
+
+	void EventLoop::AddFd(int fd, uint32_t events, Callback callback)
+	{
+		if (fd >= (int)sources.size())
+			sources.resize(fd + 1);
+
+		epoll_event event = {};
+		event.events  = events;
+		event.data.fd = fd;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) < 0)
+			throw std::runtime_error(fmt::format("Watching fd {} failed: {}", fd, strerror(errno)));
+
+		sources[fd] = std::make_shared<Source>(Source{ std::move(callback), false });
+	}
+
+	void EventLoop::ModifyFd(int fd, uint32_t events)
+	{
+		epoll_event event = {};
+		event.events  = events;
+		event.data.fd = fd;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event) < 0)
+			throw std::runtime_error(fmt::format("Changing fd {} failed: {}", fd, strerror(errno)));
+	}
+
+	void EventLoop::RemoveFd(int fd)
+	{
+		if (fd < 0 || fd >= (int)sources.size() || !sources[fd])
+			return;
+
+		epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+		sources[fd] = nullptr;
+	}
+
+	int EventLoop::AddTimer(std::chrono::nanoseconds initial, std::chrono::nanoseconds interval, Timer callback)
+	{
+		int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+		if (fd < 0)
+			throw std::runtime_error(fmt::format("timerfd_create failed: {}", strerror(errno)));
+
+		AddFd(fd, EPOLLIN, [fd, callback = std::move(callback)](uint32_t events)
+		{
+			uint64_t expirations;
+			if (read(fd, &expirations, sizeof(expirations)) == sizeof(expirations))
+				callback(expirations);
+		});
+		sources[fd]->timer = true;
+
+		SetTimer(fd, initial, interval);
+		return fd;
+	}
+
+	void EventLoop::SetTimer(int fd, std::chrono::nanoseconds initial, std::chrono::nanoseconds interval)
+	{
+		// An all zero itimerspec disarms, so a zero delay becomes the shortest possible one
+		if (initial.count() == 0)
+			initial = std::chrono::nanoseconds(1);
+
+		itimerspec spec = to_itimerspec(initial, interval);
+		timerfd_settime(fd, 0, &spec, nullptr);
+	}
+
+	void EventLoop::RemoveTimer(int fd)
+	{
+		if (fd < 0 || fd >= (int)sources.size() || !sources[fd] || !sources[fd]->timer)
+			return;
+
+		RemoveFd(fd);
+		close(fd);
+	}
+
+	bool EventLoop::Dispatch(int timeout)
+	{
+		// Nothing dispatched from here should need the heap, see Allocations.h
+		uint64_t allocations = Allocations::Count();
+
+		// Events already queued have to be dispatched before we may read more
+		while (wl_display_prepare_read(display) != 0)
+			if (wl_display_dispatch_pending(display) < 0)
+				return false;
+
+		// Only wait for the socket to drain when it is actually full
+		uint32_t events = EPOLLIN;
+		if (wl_display_flush(display) < 0)
+		{
+			if (errno != EAGAIN)
+			{
+				wl_display_cancel_read(display);
+				return false;
+			}
+
+			events |= EPOLLOUT;
+		}
+
+		if (!Watch(events))
+		{
+			wl_display_cancel_read(display);
+			return false;
+		}
+
+		epoll_event ready[MaxEvents];
+		int count = epoll_wait(epoll_fd, ready, MaxEvents, timeout);
+		if (count < 0 && errno != EINTR)
+		{
+			wl_display_cancel_read(display);
+			return false;
+		}
+
+		bool readable = false;
+		for (int a = 0; a < count; a++)
+			if (ready[a].data.fd == display_fd)
+				readable = ready[a].events & (EPOLLIN | EPOLLERR | EPOLLHUP);
+
+		// Every prepare_read has to end in exactly one of these
+		if (readable)
+		{
+			if (wl_display_read_events(display) < 0)
+				return false;
+		}
+		else
+			wl_display_cancel_read(display);
+
+		if (wl_display_dispatch_pending(display) < 0)
+			return false;
+
+		for (int a = 0; a < count; a++)
+		{
+			int fd = ready[a].data.fd;
+			if (fd == display_fd || fd >= (int)sources.size() || !sources[fd])
+				continue;
+
+			// Keeps the source alive should the callback remove it
+			std::shared_ptr<Source> source = sources[fd];
+			source->callback(ready[a].events);
+		}
+
+		Allocations::Expect(allocations, "Dispatching events");
+		return true;
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <wayland-client.h>
+
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace Wayland
+{
+	// Waits on the Wayland connection and any number of other fds with one
+	// epoll set. Each Dispatch follows the libwayland read protocol
+	// (prepare_read, flush, poll, read_events or cancel_read,
+	// dispatch_pending), so it is safe to share the display with other
+	// threads reading their own queues. Flushing that would block (EAGAIN)
+	// waits for EPOLLOUT instead of dropping requests.
+	class EventLoop
+	{
+	public:
+		using Callback = std::function<void(uint32_t events)>;
+		using Timer    = std::function<void(uint64_t expirations)>;
+
+	private:
+		struct Source
+		{
+			Callback callback;
+			bool     timer   ;
+		};
+
+		wl_display* display    = nullptr;
+		int         epoll_fd   = -1     ;
+		int         display_fd = -1     ;
+		uint32_t    watching   = 0      ; // epoll events registered for the display
+
+		std::vector<std::shared_ptr<Source>> sources; // indexed by fd, shared so a callback can remove itself
+
+		bool Watch(uint32_t events);
+
+	public:
+		void Init   (wl_display* display);
+		void Destroy(                   );
+
+		// events are EPOLLIN, EPOLLOUT, ...; the callback gets what fired
+		void AddFd   (int fd, uint32_t events, Callback callback);
+		void ModifyFd(int fd, uint32_t events                   );
+		void RemoveFd(int fd                                    );
+
+		// Returns a timerfd owned by the loop, pass it to RemoveTimer or
+		// rearm it with SetTimer. A zero interval fires once.
+		int  AddTimer   (std::chrono::nanoseconds initial, std::chrono::nanoseconds interval, Timer callback);
+		void SetTimer   (int fd, std::chrono::nanoseconds initial, std::chrono::nanoseconds interval     );
+		void RemoveTimer(int fd                                                                          );
+
+		// Waits up to timeout milliseconds (-1 forever, 0 to only poll) and
+		// dispatches whatever arrived. Returns false once the connection is
+		// unusable.
+		bool Dispatch(int timeout = -1);
+	};
+}
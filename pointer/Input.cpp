@@ -0,0 +1,180 @@
+#include "Input.h"
+
+#include <cstring>
+
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+namespace Wayland
+{
+	// Only fails when the counter would overflow, and then it is readable anyway
+	static void signal(int fd)
+	{
+		uint64_t one = 1;
+		while (write(fd, &one, sizeof(one)) < 0 && errno == EINTR);
+	}
+
+	InputThread::~InputThread()
+	{
+		Stop();
+	}
+
+	void InputThread::Init(wl_display* display)
+	{
+		this->display = display;
+
+		queue   = wl_display_create_queue(display);
+		stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+		if (queue == nullptr || stop_fd < 0 || wake_fd < 0)
+			throw std::runtime_error(fmt::format("Could not create the input queue: {}", strerror(errno)));
+	}
+
+	void InputThread::Start()
+	{
+		thread = std::thread(&InputThread::Run, this);
+	}
+
+	void InputThread::Stop()
+	{
+		if (thread.joinable())
+		{
+			signal(stop_fd);
+			thread.join();
+		}
+
+		if (stop_fd >= 0) close(stop_fd);
+		if (wake_fd >= 0) close(wake_fd);
+		if (queue       ) wl_event_queue_destroy(queue);
+
+		stop_fd = -1;
+		wake_fd = -1;
+		queue   = nullptr;
+	}
+
+	wl_event_queue* InputThread::Queue()
+	{
+		return queue;
+	}
+
+	bool InputThread::Running()
+	{
+		return thread.joinable();
+	}
+
+	std::unique_lock<std::mutex> InputThread::Lock()
+	{
+		return std::unique_lock<std::mutex>(mutex);
+	}
+
+	void InputThread::Push(const PointerFrame& frame)
+	{
+		if (frames.Push(frame))
+			pushed = true;
+		else
+			dropped++;
+	}
+
+	void InputThread::Push(const KeyEvent& key)
+	{
+		if (keys.Push(key))
+			pushed = true;
+		else
+			dropped++;
+	}
+
+	void InputThread::Push(const TouchFrame& touch)
+	{
+		if (touches.Push(touch))
+			pushed = true;
+		else
+			dropped++;
+	}
+
+	bool InputThread::Pop(PointerFrame& frame)
+	{
+		return frames.Pop(frame);
+	}
+
+	bool InputThread::Pop(KeyEvent& key)
+	{
+		return keys.Pop(key);
+	}
+
+	bool InputThread::Pop(TouchFrame& touch)
+	{
+		return touches.Pop(touch);
+	}
+
+	int InputThread::WakeFd()
+	{
+		return wake_fd;
+	}
+
+	uint64_t InputThread::Dropped()
+	{
+		return dropped;
+	}
+
+	int InputThread::dispatch()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return wl_display_dispatch_queue_pending(display, queue);
+	}
+
+	void InputThread::Run()
+	{
+		pollfd fds[2] = {
+			{ wl_display_get_fd(display), POLLIN, 0 },
+			{ stop_fd                   , POLLIN, 0 },
+		};
+
+		// The same read protocol as EventLoop::Dispatch. Whichever thread
+		// reads the socket queues each event on its own queue, so the app
+		// thread reading ours, or us reading its, is fine.
+		for (;;)
+		{
+			while (wl_display_prepare_read_queue(display, queue) != 0)
+				if (dispatch() < 0)
+					return;
+
+			// One wake per batch, not per event
+			if (pushed)
+			{
+				signal(wake_fd);
+				pushed = false;
+			}
+
+			if (poll(fds, 2, -1) < 0 && errno != EINTR)
+			{
+				wl_display_cancel_read(display);
+				return;
+			}
+
+			if (fds[1].revents)
+			{
+				wl_display_cancel_read(display);
+				return;
+			}
+
+			if (fds[0].revents & (POLLIN | POLLERR | POLLHUP))
+			{
+				// Another reader may have emptied the socket first
+				if (wl_display_read_events(display) < 0 && errno != EAGAIN)
+					return;
+			}
+			else
+				wl_display_cancel_read(display);
+
+			if (dispatch() < 0)
+				return;
+		}
+	}
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <wayland-client.h>
+
+#include "Ring.h"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace Wayland
+{
+	// Everything one wl_pointer.frame groups together, as a single event.
+	// Motion within the frame is coalesced to the latest position; Window
+	// keeps every motion sample too, when asked to.
+	struct PointerFrame
+	{
+		enum Changes : uint32_t
+		{
+			Enter     = 1 << 0,
+			Leave     = 1 << 1,
+			Motion    = 1 << 2,
+			Button    = 1 << 3,
+			Axis      = 1 << 4,
+			Axis_Stop = 1 << 5,
+		};
+
+		struct Press
+		{
+			uint32_t button;
+			uint32_t state ; // a wl_pointer_button_state
+			uint32_t serial;
+		};
+
+		static constexpr int MaxButtons = 4; // a frame with more is split
+
+		int      seat        = 0; // index in Seats
+		uint32_t changes     = 0;
+		uint32_t serial      = 0; // of the enter or leave
+		uint32_t time        = 0; // compositor timestamp of the last timed event, ms
+		double   x           = 0; // latest surface position
+		double   y           = 0;
+		int      motions     = 0; // motion events folded into x and y
+		Press    buttons[MaxButtons];
+		int      button_count = 0;
+		double   axis[2]     = {}; // summed, indexed by wl_pointer_axis
+		int32_t  discrete[2] = {};
+		uint32_t axis_source = 0;
+		uint64_t received    = 0; // CLOCK_MONOTONIC ns of the first event in the frame
+	};
+
+	// A keyboard event, already translated through the seat's keymap by
+	// whichever thread read it
+	struct KeyEvent
+	{
+		enum Type : uint8_t
+		{
+			Enter      ,
+			Leave      ,
+			Key        ,
+			Repeat     , // made up by Window while a key is held
+			Modifiers  ,
+			Repeat_Info,
+		};
+
+		enum Modifier : uint32_t
+		{
+			Shift = 1 << 0,
+			Caps  = 1 << 1,
+			Ctrl  = 1 << 2,
+			Alt   = 1 << 3,
+			Logo  = 1 << 4,
+		};
+
+		int      seat      = 0    ; // index in Seats
+		Type     type      = Key  ;
+		uint32_t time      = 0    ; // compositor timestamp, ms
+		uint32_t key       = 0    ; // a linux/input-event-codes.h key
+		uint32_t state     = 0    ; // a wl_keyboard_key_state
+		uint32_t sym       = 0    ; // an xkb_keysym_t, 0 without a keymap
+		char     text[8]   = {}   ; // what it types as UTF-8, empty for keys that type nothing
+		bool     repeats   = false;
+		uint32_t modifiers = 0    ; // Modifier bits, as of this event
+		int32_t  rate      = 0    ; // Repeat_Info, keys per second, 0 turns repeat off
+		int32_t  delay     = 0    ; // Repeat_Info, ms before the first repeat
+		uint64_t received  = 0    ; // CLOCK_MONOTONIC ns
+	};
+
+	// Every contact a touchscreen has down, as of the end of one
+	// wl_touch.frame. A finger keeps its slot from down to up, so the app can
+	// follow contacts by index; phase says what happened to each in the frame.
+	struct TouchFrame
+	{
+		enum Phase : uint8_t
+		{
+			Held     , // down since an earlier frame, and did not move
+			Down     ,
+			Motion   ,
+			Up       , // its last frame, the slot is free in the next one
+			Cancelled, // the compositor took the touch sequence over
+		};
+
+		struct Contact
+		{
+			int32_t id    = -1  ; // wl_touch id, -1 for a free slot
+			Phase   phase = Held;
+			double  x     = 0   ; // surface position
+			double  y     = 0   ;
+		};
+
+		static constexpr int MaxContacts = 10; // more fingers than this are ignored
+
+		int      seat     = 0; // index in Seats
+		uint32_t time     = 0; // compositor timestamp of the last timed event, ms
+		Contact  contacts[MaxContacts];
+		uint64_t received = 0; // CLOCK_MONOTONIC ns of the first event in the frame, 0 when nothing changed
+	};
+
+	// What a seat's pointer looks like once every frame so far is handled
+	struct PointerData
+	{
+		double xPos, yPos;
+		bool left, middle, right;
+	};
+
+	struct MotionSample
+	{
+		uint32_t time    ; // compositor timestamp, ms
+		double   x       ;
+		double   y       ;
+		uint64_t received; // CLOCK_MONOTONIC ns
+	};
+
+	// Reads and dispatches seat objects on their own wl_event_queue and
+	// thread, so input is taken off the socket as it arrives however long
+	// the app spends drawing. Listeners on that queue Push whole pointer and
+	// touch frames and translated keys into rings the app thread Pops; WakeFd becomes readable after
+	// every batch read from the socket, not after every event, so an app
+	// waiting on its event loop notices them. Listeners only run with Lock
+	// held, so the app thread holds it to add or remove devices.
+	class InputThread
+	{
+	public:
+		static constexpr size_t Capacity = 512; // frames or keys in flight, more are dropped
+
+	private:
+		wl_display    * display = nullptr;
+		wl_event_queue* queue   = nullptr;
+		int             stop_fd = -1     ;
+		int             wake_fd = -1     ;
+		std::thread     thread           ;
+		std::mutex      mutex            ; // held while dispatching
+
+		Ring<PointerFrame, Capacity> frames          ;
+		Ring<KeyEvent    , Capacity> keys            ;
+		Ring<TouchFrame  , Capacity> touches         ;
+		bool                         pushed  = false ; // since the last wake, input thread only
+		std::atomic<uint64_t>        dropped = 0     ;
+
+		void Run     ();
+		int  dispatch(); // the queue's pending events, under mutex
+
+	public:
+		~InputThread();
+
+		void            Init   (wl_display* display); // then create seat objects on Queue, then Start
+		void            Start  (                   );
+		void            Stop   (                   ); // destroys the queue too, after every seat object on it
+		wl_event_queue* Queue  (                   );
+		bool            Running(                   );
+
+		std::unique_lock<std::mutex> Lock(); // no listener runs until it is released
+
+		// Input thread, from the listeners
+		void Push(const PointerFrame& frame);
+		void Push(const KeyEvent&     key  );
+		void Push(const TouchFrame&   touch);
+
+		// App thread
+		bool     Pop    (PointerFrame& frame);
+		bool     Pop    (KeyEvent&     key  );
+		bool     Pop    (TouchFrame&   touch);
+		int      WakeFd (                   ); // read it to clear it
+		uint64_t Dropped(                   );
+	};
+}
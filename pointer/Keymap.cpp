@@ -0,0 +1,153 @@
+#include "Keymap.h"
+
+#include <cstring>
+
+#include <algorithm>
+#include <iterator>
+
+#include <sys/mman.h>
+
+namespace Wayland
+{
+	bool Keymap::Load(int fd, uint32_t size)
+	{
+		Destroy();
+
+		// Compiled straight from the compositor's pages, never copied
+		char* map = (char*)mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map == MAP_FAILED)
+			return false;
+
+		context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+		if (context)
+			keymap = xkb_keymap_new_from_buffer(context, map, strnlen(map, size), XKB_KEYMAP_FORMAT_TEXT_V1, XKB_KEYMAP_COMPILE_NO_FLAGS);
+
+		munmap(map, size);
+
+		if (keymap)
+			state = xkb_state_new(keymap);
+
+		if (state == nullptr)
+		{
+			Destroy();
+			return false;
+		}
+
+		min_code = xkb_keymap_min_keycode(keymap);
+		max_code = xkb_keymap_max_keycode(keymap);
+
+		const char* names[] = { XKB_MOD_NAME_SHIFT, XKB_MOD_NAME_CAPS, XKB_MOD_NAME_CTRL, XKB_MOD_NAME_ALT, XKB_MOD_NAME_LOGO };
+		for (size_t a = 0; a < std::size(names); a++)
+			indices[a] = xkb_keymap_mod_get_index(keymap, names[a]);
+
+		modifiers = 0;
+		build();
+
+		return true;
+	}
+
+	void Keymap::Destroy()
+	{
+		if (state  ) xkb_state_unref  (state  );
+		if (keymap ) xkb_keymap_unref (keymap );
+		if (context) xkb_context_unref(context);
+
+		state   = nullptr;
+		keymap  = nullptr;
+		context = nullptr;
+		keys    = {};
+		layouts = {};
+	}
+
+	void Keymap::build()
+	{
+		layout = xkb_state_serialize_layout(state, XKB_STATE_LAYOUT_EFFECTIVE);
+
+		size_t count = max_code - min_code + 1;
+		keys   .assign(count * MaxLevels, Key{});
+		layouts.assign(count, XKB_LAYOUT_INVALID);
+
+		for (xkb_keycode_t code = min_code; code <= max_code; code++)
+		{
+			size_t             index      = code - min_code;
+			xkb_layout_index_t key_layout = xkb_state_key_get_layout(state, code);
+
+			if (key_layout == XKB_LAYOUT_INVALID)
+				continue;
+
+			layouts[index] = key_layout;
+
+			bool              repeats = xkb_keymap_key_repeats(keymap, code);
+			xkb_level_index_t levels  = std::min(xkb_keymap_num_levels_for_key(keymap, code, key_layout), MaxLevels);
+
+			for (xkb_level_index_t level = 0; level < levels; level++)
+			{
+				Key&                key  = keys[index * MaxLevels + level];
+				const xkb_keysym_t* syms = nullptr;
+
+				key.repeats = repeats;
+
+				// A level with several symbols has no single one to give
+				if (xkb_keymap_key_get_syms_by_level(keymap, code, key_layout, level, &syms) != 1)
+					continue;
+
+				key.sym = syms[0];
+				if (xkb_keysym_to_utf8(key.sym, key.text, sizeof(key.text)) <= 0)
+					key.text[0] = '\0';
+			}
+		}
+	}
+
+	void Keymap::SetModifiers(uint32_t depressed, uint32_t latched, uint32_t locked, uint32_t group)
+	{
+		if (state == nullptr)
+			return;
+
+		xkb_state_update_mask(state, depressed, latched, locked, 0, 0, group);
+
+		modifiers = 0;
+		for (size_t a = 0; a < std::size(indices); a++)
+			if (indices[a] != XKB_MOD_INVALID && xkb_state_mod_index_is_active(state, indices[a], XKB_STATE_MODS_EFFECTIVE) > 0)
+				modifiers |= 1 << a;
+
+		// Switching layouts is rare, everything else keeps the table
+		if (xkb_state_serialize_layout(state, XKB_STATE_LAYOUT_EFFECTIVE) != layout)
+			build();
+	}
+
+	// The level already accounts for Shift, Caps Lock and AltGr as the key's
+	// type defines them. Ctrl is left to the app: the text is what the key
+	// would type without it.
+	bool Keymap::Translate(uint32_t key, KeyEvent& event)
+	{
+		xkb_keycode_t code = key + 8; // xkb keycodes are evdev ones offset by 8
+		if (state == nullptr || code < min_code || code > max_code)
+			return false;
+
+		size_t            index = code - min_code;
+		xkb_level_index_t level = xkb_state_key_get_level(state, code, layouts[index]);
+
+		if (level < MaxLevels)
+		{
+			const Key& entry = keys[index * MaxLevels + level];
+
+			event.sym     = entry.sym;
+			event.repeats = entry.repeats;
+			memcpy(event.text, entry.text, sizeof(entry.text));
+		}
+		else
+		{
+			event.sym     = xkb_state_key_get_one_sym(state, code);
+			event.repeats = xkb_keymap_key_repeats(keymap, code);
+			if (xkb_keysym_to_utf8(event.sym, event.text, sizeof(event.text)) <= 0)
+				event.text[0] = '\0';
+		}
+
+		return true;
+	}
+
+	uint32_t Keymap::Modifiers()
+	{
+		return modifiers;
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <xkbcommon/xkbcommon.h>
+
+#include "Input.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace Wayland
+{
+	// A seat's keymap, compiled once when the compositor sends it, and the
+	// modifier state the compositor keeps it in. Every key's symbols for the
+	// active layout are looked up ahead of time, so translating a key is a
+	// level lookup and a table read rather than a walk through the keymap.
+	class Keymap
+	{
+	public:
+		static constexpr xkb_level_index_t MaxLevels = 4; // plain, Shift, AltGr, both; keys with more ask xkb
+
+	private:
+		struct Key
+		{
+			uint32_t sym    ;
+			char     text[7]; // the least xkb_keysym_to_utf8 accepts
+			bool     repeats;
+		};
+
+		xkb_context* context = nullptr;
+		xkb_keymap * keymap  = nullptr;
+		xkb_state  * state   = nullptr;
+
+		xkb_keycode_t                   min_code  = 0;
+		xkb_keycode_t                   max_code  = 0;
+		xkb_layout_index_t              layout    = 0; // the one the table is for
+		std::vector<Key>                keys      ; // MaxLevels per keycode, from min_code
+		std::vector<xkb_layout_index_t> layouts   ; // the layout each key takes its symbols from
+		xkb_mod_index_t                 indices[5]; // of the KeyEvent::Modifier bits, in order
+		uint32_t                        modifiers = 0;
+
+		void build(); // the table, for the active layout
+
+	public:
+		bool     Load        (int fd, uint32_t size        ); // false when it does not compile, the fd stays open
+		void     Destroy     (                             );
+		bool     Translate   (uint32_t key, KeyEvent& event); // fills sym, text and repeats, false without a keymap
+		uint32_t Modifiers   (                             ); // KeyEvent::Modifier bits
+
+		// From wl_keyboard.modifiers
+		void     SetModifiers(uint32_t depressed, uint32_t latched, uint32_t locked, uint32_t group);
+	};
+}
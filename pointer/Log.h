@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <fmt/format.h>
+
+// Messages below this level are compiled out, arguments and all.
+// 0 trace, 1 debug, 2 info, 3 warn, 4 error, 5 nothing.
+#ifndef WAYLAND_LOG_LEVEL
+#define WAYLAND_LOG_LEVEL 2
+#endif
+
+// LOG(Info, "{}: {}", name, value) formats straight into the ring with a
+// format string checked at compile time, and returns without waiting for
+// the terminal. A newline is added to every message.
+#define LOG(level, format, ...) \
+	do \
+	{ \
+		if constexpr (Wayland::Log::Level::level >= Wayland::Log::MinLevel) \
+			Wayland::Log::Write(Wayland::Log::Level::level, FMT_STRING(format), ##__VA_ARGS__); \
+	} while (0)
+
+namespace Wayland
+{
+	namespace Log
+	{
+		enum class Level : uint8_t
+		{
+			Trace,
+			Debug,
+			Info ,
+			Warn , // Warn and Error go to stderr
+			Error,
+			Off  ,
+		};
+
+		constexpr Level  MinLevel    = (Level)WAYLAND_LOG_LEVEL;
+		constexpr size_t MessageSize = 256 ; // longer messages are truncated
+		constexpr size_t Capacity    = 1024; // messages waiting for the writer, more are dropped
+
+		struct Slot
+		{
+			std::atomic<size_t> sequence   ; // which lap of the ring the slot is ready for
+			Level               level      ;
+			uint32_t            size       ;
+			char                text[MessageSize];
+		};
+
+		Slot* Claim  (          ); // nullptr when the ring is full, the message is dropped
+		void  Publish(Slot* slot); // hands a claimed slot to the writer thread
+		void  Flush  (          ); // waits until everything logged so far is written
+
+		template<typename S, typename... Args>
+		void Write(Level level, const S& format, const Args&... args)
+		{
+			Slot* slot = Claim();
+			if (slot == nullptr)
+				return;
+
+			auto result = fmt::format_to_n(slot->text, MessageSize, format, args...);
+
+			slot->level = level;
+			slot->size  = result.size < MessageSize ? result.size : MessageSize;
+
+			Publish(slot);
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#include "Outputs.h"
+
+#include <cstdint>
+
+namespace Wayland
+{
+	int Outputs::Add(wl_output* output, uint32_t name)
+	{
+		for (int a = 0; a < Capacity; a++)
+		{
+			if (outputs[a].name != 0)
+				continue;
+
+			outputs[a]        = Output{};
+			outputs[a].name   = name  ;
+			outputs[a].output = output;
+			outputs[a].atomic = wl_output_get_version(output) >= WL_OUTPUT_DONE_SINCE_VERSION;
+
+			if (a >= used)
+				used = a + 1;
+
+			return a;
+		}
+
+		return -1;
+	}
+
+	void Outputs::Remove(int index)
+	{
+		outputs[index] = Output{};
+
+		while (used > 0 && outputs[used - 1].name == 0)
+			used--;
+	}
+
+	int Outputs::Find(uint32_t name)
+	{
+		for (int a = 0; a < used; a++)
+			if (outputs[a].name == name)
+				return a;
+
+		return -1;
+	}
+
+	int Outputs::Find(wl_output* output)
+	{
+		if (output == nullptr)
+			return -1;
+
+		for (int a = 0; a < used; a++)
+			if (outputs[a].output == output)
+				return a;
+
+		return -1;
+	}
+
+	int Outputs::Used()
+	{
+		return used;
+	}
+
+	Output& Outputs::operator[](int index)
+	{
+		return outputs[index];
+	}
+
+	uint32_t Outputs::Bit(int index)
+	{
+		return 1u << index;
+	}
+
+	void* Outputs::Data(int index)
+	{
+		return (void*)(uintptr_t)index;
+	}
+
+	int Outputs::Index(void* data)
+	{
+		return (int)(uintptr_t)data;
+	}
+}
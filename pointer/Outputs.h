@@ -0,0 +1,54 @@
+#pragma once
+
+#include <wayland-client.h>
+
+#include <cstdint>
+
+namespace Wayland
+{
+	// What an output shows, as of its last wl_output.done
+	struct OutputMode
+	{
+		int32_t width     = 0; // px of the current mode
+		int32_t height    = 0;
+		int32_t refresh   = 0; // mHz of the current mode, 0 when the compositor does not say
+		int32_t scale     = 1;
+		int32_t transform = WL_OUTPUT_TRANSFORM_NORMAL;
+	};
+
+	// One wl_output. Like a seat, its index never changes while it is bound
+	// and is the user data of its listener. Windows keep the outputs they are
+	// on as a bit per index.
+	struct Output
+	{
+		uint32_t   name    = 0      ; // registry name, 0 while the slot is free
+		wl_output* output  = nullptr;
+		bool       atomic  = false  ; // the compositor sends wl_output.done, v2 and up
+		OutputMode pending          ; // being sent, applied on done
+		OutputMode current          ;
+	};
+
+	// Every bound output, in a flat array. Outputs come and go with the
+	// registry, and a freed slot is reused by the next output to arrive.
+	class Outputs
+	{
+	public:
+		static constexpr int Capacity = 16; // more outputs than this are ignored, fits the windows' masks
+
+	private:
+		Output outputs[Capacity];
+		int    used = 0; // every bound slot is below this
+
+	public:
+		int     Add   (wl_output* output, uint32_t name); // the slot's index, -1 when they are all taken
+		void    Remove(int index                       );
+		int     Find  (uint32_t name                   ); // -1 when no output has it
+		int     Find  (wl_output* output               ); // -1 for nullptr and outputs we ignored
+		int     Used  (                                ); // loop below this, skipping free slots
+		Output& operator[](int index);
+
+		static uint32_t Bit  (int index ); // in a window's mask of outputs
+		static void*    Data (int index ); // listener user data for a slot
+		static int      Index(void* data);
+	};
+}
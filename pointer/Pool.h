@@ -0,0 +1,44 @@
+#pragma once
+
+#include <wayland-client.h>
+#include <wayland-client-protocol.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Wayland
+{
+	// A wl_shm_pool that grows geometrically with ftruncate, mremap and
+	// wl_shm_pool_resize instead of being recreated, and hands out buffers
+	// at offsets inside it. Offsets stay valid across growth, pointers
+	// returned by Data do not.
+	class Pool
+	{
+		struct Range
+		{
+			size_t offset;
+			size_t size  ;
+		};
+
+		wl_shm     * shm   = nullptr;
+		wl_shm_pool* pool  = nullptr;
+		char       * data  = nullptr;
+		size_t       size  = 0      ;
+		int          fd    = -1     ;
+		bool         memfd = false  ; // grown sparse, see SharedMemory::Grow
+
+		std::vector<Range> free_ranges; // sorted by offset and coalesced
+
+		void Grow(size_t needed);
+
+	public:
+		void       Init        (wl_shm* shm                                                            );
+		size_t     Allocate    (size_t size                                                            );
+		void       Free        (size_t offset, size_t size                                             );
+		wl_buffer* CreateBuffer(size_t offset, int width, int height, int stride, uint32_t format      );
+		char*      Data        (size_t offset                                                          );
+		size_t     Size        (                                                                       );
+		void       Destroy     (                                                                       );
+	};
+}
@@ -0,0 +1,197 @@
+#include "Presentation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace Wayland
+{
+	namespace Functions
+	{
+		namespace WP_Presentation_Feedback
+		{
+			// Always before presented, when the frame was synchronized to an output
+			void Sync_Output(void* data, struct wp_presentation_feedback* wp_presentation_feedback, wl_output* output)
+			{
+				Presentation* presentation = (Presentation*)data;
+				presentation->find(wp_presentation_feedback)->output = output;
+			}
+
+			void Presented(void* data, struct wp_presentation_feedback* wp_presentation_feedback, uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec, uint32_t refresh, uint32_t seq_hi, uint32_t seq_lo, uint32_t flags)
+			{
+				Presentation*          presentation = (Presentation*)data;
+				Presentation::Pending* pending      = presentation->find(wp_presentation_feedback);
+
+				FrameTiming frame;
+				frame.committed = pending->committed;
+				frame.output    = pending->output   ;
+				frame.presented = ((uint64_t)tv_sec_hi << 32 | tv_sec_lo) * 1000000000 + tv_nsec;
+				frame.sequence  = (uint64_t)seq_hi << 32 | seq_lo;
+				frame.refresh   = refresh;
+				frame.flags     = flags;
+
+				presentation->add(frame);
+
+				wp_presentation_feedback_destroy(wp_presentation_feedback);
+				*pending = {};
+			}
+
+			void Discarded(void* data, struct wp_presentation_feedback* wp_presentation_feedback)
+			{
+				Presentation* presentation = (Presentation*)data;
+
+				*presentation->find(wp_presentation_feedback) = {};
+				presentation->discarded++;
+
+				wp_presentation_feedback_destroy(wp_presentation_feedback);
+			}
+		}
+	}
+
+	namespace Listeners
+	{
+		wp_presentation_feedback_listener wp_presentation_feedback
+		{
+			.sync_output = Functions::WP_Presentation_Feedback::Sync_Output,
+			.presented   = Functions::WP_Presentation_Feedback::Presented,
+			.discarded   = Functions::WP_Presentation_Feedback::Discarded
+		};
+	}
+
+	// Nearest rank, so every percentile is a latency that was measured
+	static int rank(double percentile, int count)
+	{
+		int index = (int)std::ceil(percentile / 100 * count) - 1;
+		return std::clamp(index, 0, count - 1);
+	}
+
+	void Presentation::Init(wp_presentation* presentation, clockid_t clock)
+	{
+		this->presentation = presentation;
+		this->clock        = clock       ;
+	}
+
+	uint64_t Presentation::Now()
+	{
+		timespec time;
+		clock_gettime(clock, &time);
+
+		return time.tv_sec * 1000000000ull + time.tv_nsec;
+	}
+
+	Presentation::Pending* Presentation::find(struct wp_presentation_feedback* feedback)
+	{
+		return std::find_if(std::begin(pending), std::end(pending), [feedback](const Pending& slot) { return slot.feedback == feedback; });
+	}
+
+	void Presentation::Commit(wl_surface* surface)
+	{
+		if (presentation == nullptr)
+			return;
+
+		Pending* slot = find(nullptr);
+		if (slot == std::end(pending))
+			return;
+
+		slot->feedback  = wp_presentation_feedback(presentation, surface);
+		slot->committed = Now();
+		wp_presentation_feedback_add_listener(slot->feedback, &Listeners::wp_presentation_feedback, this);
+	}
+
+	void Presentation::Destroy()
+	{
+		for (Pending& slot : pending)
+			if (slot.feedback)
+				wp_presentation_feedback_destroy(slot.feedback);
+
+		for (Pending& slot : pending) slot = {};
+		presented = 0;
+		discarded = 0;
+	}
+
+	void Presentation::add(FrameTiming frame)
+	{
+		// A frame is late by every refresh after its commit that went by
+		// without it. The previous frame's is the only refresh we know the
+		// time of, so they are counted from there. A window that moved to
+		// another output has nothing to count from: the outputs' counters and
+		// refreshes have nothing to do with each other.
+		if (presented > 0 && frame.refresh > 0)
+		{
+			const FrameTiming& previous = frames[(presented - 1) % Capacity];
+
+			if (frame.presented > previous.presented && frame.output == previous.output)
+			{
+				uint64_t shown = frame.sequence && previous.sequence ? frame.sequence - previous.sequence
+				                                                     : (frame.presented - previous.presented + frame.refresh / 2) / frame.refresh;
+				uint64_t ready = frame.committed < previous.presented ? 1 : (frame.committed - previous.presented) / frame.refresh + 1;
+
+				if (shown > ready)
+					frame.missed = shown - ready;
+			}
+		}
+
+		frames[presented % Capacity] = frame;
+		presented++;
+	}
+
+	int Presentation::latencies(uint32_t* out)
+	{
+		int count = std::min<uint64_t>(presented, Capacity);
+
+		// A compositor estimating presentation can put it before the commit
+		for (int a = 0; a < count; a++)
+			out[a] = frames[a].presented > frames[a].committed ? std::min<uint64_t>(frames[a].presented - frames[a].committed, UINT32_MAX) : 0;
+
+		return count;
+	}
+
+	PresentStats Presentation::Stats()
+	{
+		PresentStats stats;
+		stats.presented = presented;
+		stats.discarded = discarded;
+
+		uint32_t sorted[Capacity];
+		stats.frames = latencies(sorted);
+		if (stats.frames == 0)
+			return stats;
+
+		std::sort(sorted, sorted + stats.frames);
+
+		for (int a = 0; a < stats.frames; a++)
+		{
+			stats.missed    += frames[a].missed;
+			stats.vsync     += (frames[a].flags & WP_PRESENTATION_FEEDBACK_KIND_VSYNC    ) != 0;
+			stats.zero_copy += (frames[a].flags & WP_PRESENTATION_FEEDBACK_KIND_ZERO_COPY) != 0;
+		}
+
+		stats.refresh     = frames[(presented - 1) % Capacity].refresh;
+		stats.latency_p50 = sorted[rank(50, stats.frames)];
+		stats.latency_p90 = sorted[rank(90, stats.frames)];
+		stats.latency_p99 = sorted[rank(99, stats.frames)];
+		stats.latency_max = sorted[stats.frames - 1];
+
+		return stats;
+	}
+
+	uint32_t Presentation::Latency(double percentile)
+	{
+		uint32_t values[Capacity];
+		int      count = latencies(values);
+		if (count == 0)
+			return 0;
+
+		std::nth_element(values, values + rank(percentile, count), values + count);
+		return values[rank(percentile, count)];
+	}
+
+	bool Presentation::Last(FrameTiming& frame)
+	{
+		if (presented == 0)
+			return false;
+
+		frame = frames[(presented - 1) % Capacity];
+		return true;
+	}
+}
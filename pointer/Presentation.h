@@ -0,0 +1,92 @@
+#pragma once
+
+#include <wayland-client.h>
+#include <presentation-time-client-protocol.h>
+
+#include <cstdint>
+
+#include <time.h>
+
+namespace Wayland
+{
+	namespace Functions
+	{
+		namespace WP_Presentation_Feedback
+		{
+			void Sync_Output(void*, struct wp_presentation_feedback*, wl_output*);
+			void Presented(void*, struct wp_presentation_feedback*, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+			void Discarded(void*, struct wp_presentation_feedback*);
+		}
+	}
+
+	// One commit, as the compositor showed it
+	struct FrameTiming
+	{
+		uint64_t   committed = 0      ; // ns on the presentation clock
+		uint64_t   presented = 0      ; // ns on the presentation clock, when it turned into light
+		uint64_t   sequence  = 0      ; // the output's refresh counter, 0 when it has none
+		uint32_t   refresh   = 0      ; // ns between the output's refreshes, 0 when it varies
+		uint32_t   missed    = 0      ; // refreshes that went by after it was committed, without it
+		uint32_t   flags     = 0      ; // wp_presentation_feedback_kind bits
+		wl_output* output    = nullptr; // the one it was synchronized to, nullptr when the compositor did not say
+	};
+
+	// Over the frames still in a window's ring, latencies are from commit to presented
+	struct PresentStats
+	{
+		uint64_t presented   = 0; // since the window opened
+		uint64_t discarded   = 0; // replaced before the compositor could show them
+		int      frames      = 0; // the percentiles are over this many
+		uint64_t missed      = 0; // refreshes
+		int      vsync       = 0; // frames shown without tearing
+		int      zero_copy   = 0; // frames scanned out straight from our buffer
+		uint32_t refresh     = 0; // ns, of the newest frame
+		uint32_t latency_p50 = 0; // ns
+		uint32_t latency_p90 = 0;
+		uint32_t latency_p99 = 0;
+		uint32_t latency_max = 0;
+	};
+
+	// A window's presentation feedback. Each commit asks for feedback, and
+	// each feedback is kept in a ring as one FrameTiming, so the latency of
+	// the last few seconds of frames can be read at any time. Nothing here
+	// allocates: the pending feedback and the ring are fixed arrays.
+	class Presentation
+	{
+	public:
+		static constexpr int Capacity   = 256; // frames kept, the newest overwrite the oldest
+		static constexpr int MaxPending = 8  ; // commits waiting for feedback, later ones are not measured
+
+	private:
+		struct Pending
+		{
+			struct wp_presentation_feedback* feedback  = nullptr; // nullptr while the slot is free
+			uint64_t                         committed = 0      ;
+			wl_output*                       output    = nullptr; // from sync_output
+		};
+
+		wp_presentation* presentation = nullptr; // nullptr when the compositor has no presentation time
+		clockid_t        clock        = CLOCK_MONOTONIC;
+		Pending          pending[MaxPending];
+		FrameTiming      frames [Capacity  ];
+		uint64_t         presented    = 0; // frames[presented % Capacity] is the next to write
+		uint64_t         discarded    = 0;
+
+		Pending* find     (struct wp_presentation_feedback* feedback);
+		void     add      (FrameTiming frame                        ); // works out missed from the frame before it
+		int      latencies(uint32_t* out                            ); // of every frame in the ring, returns how many
+
+	public:
+		friend void Functions::WP_Presentation_Feedback::Sync_Output(void*, struct wp_presentation_feedback*, wl_output*);
+		friend void Functions::WP_Presentation_Feedback::Presented(void*, struct wp_presentation_feedback*, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+		friend void Functions::WP_Presentation_Feedback::Discarded(void*, struct wp_presentation_feedback*);
+
+		void         Init   (wp_presentation* presentation, clockid_t clock); // nullptr measures nothing
+		void         Commit (wl_surface* surface    ); // just before wl_surface_commit
+		void         Destroy(                       ); // drops feedback still pending
+		PresentStats Stats  (                       );
+		uint32_t     Latency(double percentile      ); // ns, 0 until a frame has been presented
+		bool         Last   (FrameTiming& frame     ); // the newest frame, false until there is one
+		uint64_t     Now    (                       ); // ns on the presentation clock
+	};
+}
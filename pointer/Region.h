@@ -0,0 +1,48 @@
+#pragma once
+
+namespace Wayland
+{
+	struct Rect
+	{
+		int x      = 0;
+		int y      = 0;
+		int width  = 0;
+		int height = 0;
+
+		bool Empty    (                  ) const;
+		int  Area     (                  ) const;
+		bool Contains (const Rect& other ) const;
+		Rect Union    (const Rect& other ) const;
+		Rect Intersect(const Rect& other ) const;
+	};
+
+	// A set of at most MaxRects rectangles covering everything added to it.
+	// Once full, the two rectangles whose bounding box wastes the least area
+	// are merged, so the region only ever grows and never needs to allocate.
+	class Region
+	{
+	public:
+		static constexpr int MaxRects = 8;
+
+	private:
+		Rect rects[MaxRects];
+		int  count = 0;
+
+		void Remove(int index);
+
+	public:
+		void Add   (const Rect& rect     );
+		void Add   (const Region& region );
+		void Clip  (const Rect& bounds   );
+		void Clear (                     );
+		bool Empty (                     ) const;
+		int  Area  (                     ) const; // upper bound, rectangles may overlap
+		Rect Bounds(                     ) const;
+
+		bool operator==(const Region& other) const;
+		bool operator!=(const Region& other) const { return !(*this == other); }
+
+		const Rect* begin() const { return rects        ; }
+		const Rect* end  () const { return rects + count; }
+	};
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace Wayland
+{
+	// A fixed size queue between exactly one producer thread and one
+	// consumer thread. Each side only writes its own index, so neither ever
+	// waits on the other; a full ring refuses the push instead.
+	template<typename T, size_t Capacity>
+	class Ring
+	{
+		static_assert((Capacity & (Capacity - 1)) == 0, "Ring capacity must be a power of two");
+
+		T items[Capacity];
+
+		alignas(64) std::atomic<size_t> head = 0; // next to push, written by the producer
+		alignas(64) std::atomic<size_t> tail = 0; // next to pop, written by the consumer
+
+	public:
+		// Producer only, false when full
+		bool Push(const T& item)
+		{
+			size_t position = head.load(std::memory_order_relaxed);
+			if (position - tail.load(std::memory_order_acquire) == Capacity)
+				return false;
+
+			items[position % Capacity] = item;
+			head.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer only, false when empty
+		bool Pop(T& item)
+		{
+			size_t position = tail.load(std::memory_order_relaxed);
+			if (position == head.load(std::memory_order_acquire))
+				return false;
+
+			item = items[position % Capacity];
+			tail.store(position + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool Empty() const
+		{
+			return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+		}
+	};
+}
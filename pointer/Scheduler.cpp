@@ -0,0 +1,68 @@
+#include "Scheduler.h"
+
+#include <algorithm>
+
+namespace Wayland
+{
+	uint64_t Scheduler::Budget()
+	{
+		return cost + 4 * deviation + margin;
+	}
+
+	uint64_t Scheduler::Next(const FrameTiming& last, uint64_t now)
+	{
+		// Without a steady refresh there is nothing to aim for
+		if (last.refresh == 0 || now > last.presented + MaxIdle * last.refresh)
+			return now;
+
+		// A frame that cannot be done in a refresh gains nothing from waiting
+		uint64_t budget = Budget();
+		if (budget >= last.refresh)
+			return now;
+
+		// The first refresh after the last one presented that can still be made
+		uint64_t refresh = last.presented + last.refresh;
+		if (now + budget > refresh)
+			refresh += (now + budget - refresh + last.refresh - 1) / last.refresh * last.refresh;
+
+		return refresh - budget;
+	}
+
+	void Scheduler::Measure(uint64_t start, uint64_t committed)
+	{
+		uint64_t sample = committed > start ? committed - start : 0;
+
+		if (cost == 0)
+		{
+			cost      = sample    ;
+			deviation = sample / 2;
+			return;
+		}
+
+		uint64_t error = sample > cost ? sample - cost : cost - sample;
+
+		// Gains of 1/8 and 1/4, as TCP uses for round trip times
+		cost      = cost      - cost      / 8 + sample / 8;
+		deviation = deviation - deviation / 4 + error  / 4;
+	}
+
+	void Scheduler::Presented(const FrameTiming& frame)
+	{
+		if (frame.presented == seen)
+			return;
+
+		seen = frame.presented;
+
+		if (frame.missed > 0)
+		{
+			margin = std::min(margin * 2, (uint64_t)frame.refresh / 2);
+			hits   = 0;
+		}
+		else if (++hits >= ShrinkAfter)
+		{
+			// Now and then this finds the compositor needs more, at the cost of one late frame
+			margin = std::max(margin - margin / 8, MinMargin);
+			hits   = 0;
+		}
+	}
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Presentation.h"
+
+#include <cstdint>
+
+namespace Wayland
+{
+	// Decides when a window starts drawing its next frame: as late as it can
+	// while still committing in time for the refresh after the last one
+	// presented. Input sampled at the start of the frame is then only as
+	// old as the frame takes to draw, instead of up to a whole refresh.
+	//
+	// The refresh and its phase come from presentation feedback. What a
+	// frame takes is a moving average of the frames measured so far, plus
+	// four times their average deviation from it, like a TCP retransmit
+	// timeout. On top of that goes a margin for the compositor to pick the
+	// commit up before the refresh. It doubles whenever a frame misses its
+	// refresh and shrinks slowly while none do.
+	class Scheduler
+	{
+	public:
+		static constexpr uint64_t InitialMargin = 4000000; // ns, until frames show how little the compositor needs
+		static constexpr uint64_t MinMargin     = 500000 ; // ns
+		static constexpr int      ShrinkAfter   = 120    ; // frames in a row that made their refresh
+		static constexpr uint64_t MaxIdle       = 64     ; // refreshes since the last frame, after that its phase is not trusted
+
+	private:
+		uint64_t cost      = 0; // ns, from a frame's start to its commit, 0 until one is measured
+		uint64_t deviation = 0; // ns
+		uint64_t margin    = InitialMargin;
+		uint64_t seen      = 0; // presented time of the newest frame the margin has taken into account
+		int      hits      = 0; // frames in a row that made their refresh
+
+	public:
+		uint64_t Next     (const FrameTiming& last, uint64_t now); // when to start, on the presentation clock; now or earlier means straight away
+		void     Measure  (uint64_t start, uint64_t committed   ); // a frame drawn, start being when it was due rather than when it woke
+		void     Presented(const FrameTiming& frame             ); // every frame presented, at least the newest of them
+		uint64_t Budget   (                                     ); // ns before a refresh a frame has to start
+	};
+}
@@ -0,0 +1,63 @@
+#include "Seats.h"
+
+#include <cstdint>
+
+namespace Wayland
+{
+	int Seats::Add(wl_seat* seat, uint32_t name)
+	{
+		for (int a = 0; a < Capacity; a++)
+		{
+			if (seats[a].name != 0)
+				continue;
+
+			seats[a]      = Seat{};
+			seats[a].name = name;
+			seats[a].seat = seat;
+
+			if (a >= used)
+				used = a + 1;
+
+			return a;
+		}
+
+		return -1;
+	}
+
+	void Seats::Remove(int index)
+	{
+		seats[index] = Seat{};
+
+		while (used > 0 && seats[used - 1].name == 0)
+			used--;
+	}
+
+	int Seats::Find(uint32_t name)
+	{
+		for (int a = 0; a < used; a++)
+			if (seats[a].name == name)
+				return a;
+
+		return -1;
+	}
+
+	int Seats::Used()
+	{
+		return used;
+	}
+
+	Seat& Seats::operator[](int index)
+	{
+		return seats[index];
+	}
+
+	void* Seats::Data(int index)
+	{
+		return (void*)(uintptr_t)index;
+	}
+
+	int Seats::Index(void* data)
+	{
+		return (int)(uintptr_t)data;
+	}
+}
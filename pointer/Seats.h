@@ -0,0 +1,72 @@
+#pragma once
+
+#include <wayland-client.h>
+#include <cursor-shape-v1-client-protocol.h>
+
+#include "Cursors.h"
+#include "Input.h"
+#include "Keymap.h"
+
+#include <cstdint>
+
+namespace Wayland
+{
+	// One wl_seat and the devices it has right now. Its index never changes
+	// while it is bound, and is the user data of its listeners, so an event
+	// finds its seat without a lookup.
+	struct Seat
+	{
+		uint32_t                   name           = 0      ; // registry name, 0 while the slot is free
+		wl_seat                  * seat           = nullptr;
+		uint32_t                   capabilities   = 0      ;
+		char                       label[32]      = {}     ; // wl_seat.name, truncated
+
+		wl_pointer               * pointer        = nullptr;
+		bool                       pointer_frames = false  ; // the compositor sends wl_pointer.frame, v5 and up
+		PointerFrame               pointer_frame           ; // being built, on whichever thread reads input
+		PointerData                pointer_data   = {}     ; // as of the last frame handled, app thread
+
+		// The pointer's cursor, all on the app thread. With a shape device
+		// the compositor draws it, and there is no surface.
+		wp_cursor_shape_device_v1* cursor_device  = nullptr;
+		wl_surface               * cursor_surface = nullptr; // reused for every cursor the pointer shows
+		wl_callback              * cursor_frame   = nullptr; // pending while an animated cursor is shown
+		wl_cursor                * cursor         = nullptr; // shown now
+		Cursors::Shape             cursor_shape   = Cursors::Default; // the one the app wants
+		int                        cursor_image   = 0      ; // of cursor, attached now
+		uint32_t                   cursor_start   = 0      ; // compositor ms the animation started at, 0 until its first frame
+		uint32_t                   cursor_serial  = 0      ; // of the enter, 0 while the pointer is elsewhere
+
+		wl_touch                 * touch          = nullptr;
+		TouchFrame                 touch_frame             ; // contacts being tracked, on whichever thread reads input
+		TouchFrame                 touch_data              ; // the last frame handled, app thread
+
+		wl_keyboard              * keyboard       = nullptr;
+		Keymap                     keymap                  ; // on whichever thread reads input
+		int32_t                    repeat_rate    = 25     ; // keys per second, app thread
+		int32_t                    repeat_delay   = 600    ; // ms
+	};
+
+	// Every bound seat, in a flat array. Seats come and go with the registry,
+	// and a freed slot is reused by the next seat to arrive. A slot's devices
+	// and keymap must be destroyed before it is removed.
+	class Seats
+	{
+	public:
+		static constexpr int Capacity = 8; // more seats than this are ignored
+
+	private:
+		Seat seats[Capacity];
+		int  used = 0; // every bound slot is below this
+
+	public:
+		int   Add   (wl_seat* seat, uint32_t name); // the slot's index, -1 when they are all taken
+		void  Remove(int index                   );
+		int   Find  (uint32_t name               ); // -1 when no seat has it
+		int   Used  (                            ); // loop below this, skipping free slots
+		Seat& operator[](int index);
+
+		static void* Data (int index ); // listener user data for a slot
+		static int   Index(void* data);
+	};
+}
@@ -0,0 +1,155 @@
+#include "SharedMemory.h"
+
+#include <cstring>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <errno.h>
+#include <unistd.h>
+
+static int set_cloexec_or_close(int fd)
+{
+	long flags;
+
+	if (fd == -1)
+			return -1;
+
+	flags = fcntl(fd, F_GETFD);
+	if (flags == -1)
+		goto err;
+
+	if (fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1)
+		goto err;
+
+	return fd;
+
+err:
+	close(fd);
+	return -1;
+}
+
+static int create_tmpfile_cloexec(char *tmpname)
+{
+	int fd;
+
+#ifdef HAVE_MKOSTEMP
+	fd = mkostemp(tmpname, O_CLOEXEC);
+	if (fd >= 0)
+			unlink(tmpname);
+#else
+	fd = mkstemp(tmpname);
+	if (fd >= 0) {
+		fd = set_cloexec_or_close(fd);
+		unlink(tmpname);
+	}
+#endif
+
+	return fd;
+}
+
+static int create_tmpfile()
+{
+	static const char templatea[] = "/weston-shared-XXXXXX";
+	const char *path;
+	char *name;
+	int fd;
+
+	path = getenv("XDG_RUNTIME_DIR");
+	if (!path) {
+		errno = ENOENT;
+		return -1;
+	}
+
+	name = (char*)malloc(strlen(path) + sizeof(templatea));
+	if (!name)
+		return -1;
+	strcpy(name, path);
+	strcat(name, templatea);
+
+	fd = create_tmpfile_cloexec(name);
+
+	free(name);
+
+	return fd;
+}
+
+namespace Wayland
+{
+	namespace SharedMemory
+	{
+		int Create(off_t size, unsigned seals, bool* memfd)
+		{
+			int fd = -1;
+
+			if (memfd)
+				*memfd = false;
+
+#ifdef MFD_ALLOW_SEALING
+			fd = memfd_create("wayland-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+			if (fd >= 0)
+			{
+				if (ftruncate(fd, size) < 0)
+				{
+					int error = errno;
+					close(fd);
+					errno = error;
+					return -1;
+				}
+
+				int flags = F_SEAL_SEAL;
+				if (seals & SealShrink) flags |= F_SEAL_SHRINK;
+				if (seals & SealGrow  ) flags |= F_SEAL_GROW  ;
+
+				// Sealing is only a safety net, a kernel without it still gives a usable file
+				fcntl(fd, F_ADD_SEALS, flags);
+
+				if (memfd)
+					*memfd = true;
+				return fd;
+			}
+#endif
+
+			fd = create_tmpfile();
+			if (fd < 0)
+				return -1;
+
+			if (!Grow(fd, size, false))
+			{
+				int error = errno;
+				close(fd);
+				errno = error;
+				return -1;
+			}
+
+			return fd;
+		}
+
+		bool Grow(int fd, off_t size, bool memfd)
+		{
+			// Pools grow geometrically, so committing pages for all of it would
+			// pay for space that may never hold a buffer
+			if (memfd)
+				return ftruncate(fd, size) == 0;
+
+			// A file in XDG_RUNTIME_DIR shares its tmpfs with everything else
+			// there. posix_fallocate makes running out of space an error here
+			// instead of a SIGBUS on first touch, but not every filesystem supports it.
+			int error;
+			do
+				error = posix_fallocate(fd, 0, size);
+			while (error == EINTR);
+
+			if (error == 0)
+				return true;
+
+			if (error != EINVAL && error != EOPNOTSUPP)
+			{
+				errno = error;
+				return false;
+			}
+
+			return ftruncate(fd, size) == 0;
+		}
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <sys/types.h>
+
+namespace Wayland
+{
+	namespace SharedMemory
+	{
+		enum Seal : unsigned
+		{
+			SealNone   = 0     ,
+			SealShrink = 1 << 0, // the compositor can never see the file shrink under it
+			SealGrow   = 1 << 1, // the file is fixed size, Grow will fail
+		};
+
+		// Creates an anonymous, close-on-exec file of the given size for use
+		// with wl_shm. Uses memfd_create and file seals when available and
+		// falls back to an unlinked file in XDG_RUNTIME_DIR otherwise.
+		// memfd, when given, says which it was. Returns -1 and sets errno on
+		// failure.
+		int  Create(off_t size, unsigned seals = SealShrink, bool* memfd = nullptr);
+
+		// Grows the file to at least size bytes, it never shrinks. A memfd
+		// stays sparse, as Create made it; other files get their space up front.
+		bool Grow  (int fd, off_t size, bool memfd);
+	}
+}
@@ -1,10 +1,15 @@
 #include "Wayland.h"
+#include "Fill.h"
+#include "Log.h"
 
+#include <cstdio>
 #include <cstring>
 #include <cstdint>
 
+#include <algorithm>
+#include <iterator>
 #include <stdexcept>
-#include <iostream>
+#include <string_view>
 #include <vector>
 
 #include <fmt/format.h>
@@ -14,121 +19,289 @@
 #include <errno.h>
 #include <unistd.h>
 #include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
 
 #define WL_ARRAY_FOR_EACH(pos, array, type) \
 	for (pos = (type)(array)->data; \
 	     (const char *) pos < ((const char *) (array)->data + (array)->size); \
 	     (pos)++)
 
-static int set_cloexec_or_close(int fd)
+namespace Wayland
 {
-	long flags;
-
-	if (fd == -1)
-			return -1;
-
-	flags = fcntl(fd, F_GETFD);
-	if (flags == -1)
-		goto err;
-
-	if (fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1)
-		goto err;
-
-	return fd;
-
-err:
-	close(fd);
-	return -1;
-}
+	wl_display*                 display;
+	wl_registry*                registry;
+	wl_compositor*              compositor;
+	wl_shell*                   shell;
+	xdg_wm_base*                wm_base;
+	Seats                       seats;
+	Outputs                     outputs;
+	Cursors                     cursors;
+	wl_shm*                     shm;
+	zxdg_decoration_manager_v1* decoration_manager;
+	wp_cursor_shape_manager_v1* cursor_shape_manager; // optional, cursors are themed without it
+	wp_presentation*            presentation; // optional, frames are not measured without it
+	clockid_t                   presentation_clock = CLOCK_MONOTONIC; // what its timestamps are on
+	EventLoop                   event_loop;
+	Window*                     input_window; // where seats put their devices, the last one Init
 
-static int create_tmpfile_cloexec(char *tmpname)
-{
-	int fd;
+	static uint64_t monotonic_ns()
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
 
-#ifdef HAVE_MKOSTEMP
-	fd = mkostemp(tmpname, O_CLOEXEC);
-	if (fd >= 0)
-			unlink(tmpname);
-#else
-	fd = mkstemp(tmpname);
-	if (fd >= 0) {
-		fd = set_cloexec_or_close(fd);
-		unlink(tmpname);
+		return now.tv_sec * 1000000000ull + now.tv_nsec;
 	}
-#endif
 
-	return fd;
-}
+	// Names for logging. Constant tables, so dispatching an event never
+	// allocates to describe it.
+	namespace Names
+	{
+		struct ShmFormatName
+		{
+			uint32_t         format;
+			std::string_view name  ;
+		};
 
-int os_create_anonymous_file(off_t size)
-{
-	static const char templatea[] = "/weston-shared-XXXXXX";
-	const char *path;
-	char *name;
-	int fd;
+		#define Format(name) ShmFormatName{ WL_SHM_FORMAT_##name, "WL_SHM_FORMAT_" #name }
+
+		constexpr ShmFormatName shm_formats[] = {
+			Format(ARGB8888),
+			Format(XRGB8888),
+			Format(C8),
+			Format(RGB332),
+			Format(BGR233),
+			Format(XRGB4444),
+			Format(XBGR4444),
+			Format(RGBX4444),
+			Format(BGRX4444),
+			Format(ARGB4444),
+			Format(ABGR4444),
+			Format(RGBA4444),
+			Format(BGRA4444),
+			Format(XRGB1555),
+			Format(XBGR1555),
+			Format(RGBX5551),
+			Format(BGRX5551),
+			Format(ARGB1555),
+			Format(ABGR1555),
+			Format(RGBA5551),
+			Format(BGRA5551),
+			Format(RGB565),
+			Format(BGR565),
+			Format(RGB888),
+			Format(BGR888),
+			Format(XBGR8888),
+			Format(RGBX8888),
+			Format(BGRX8888),
+			Format(ABGR8888),
+			Format(RGBA8888),
+			Format(BGRA8888),
+			Format(XRGB2101010),
+			Format(XBGR2101010),
+			Format(RGBX1010102),
+			Format(BGRX1010102),
+			Format(ARGB2101010),
+			Format(ABGR2101010),
+			Format(RGBA1010102),
+			Format(BGRA1010102),
+			Format(YUYV),
+			Format(YVYU),
+			Format(UYVY),
+			Format(VYUY),
+			Format(AYUV),
+			Format(NV12),
+			Format(NV21),
+			Format(NV16),
+			Format(NV61),
+			Format(YUV410),
+			Format(YVU410),
+			Format(YUV411),
+			Format(YVU411),
+			Format(YUV420),
+			Format(YVU420),
+			Format(YUV422),
+			Format(YVU422),
+			Format(YUV444),
+			Format(YVU444),
+		};
 
-	path = getenv("XDG_RUNTIME_DIR");
-	if (!path) {
-		errno = ENOENT;
-		return -1;
-	}
+		#undef Format
+
+		constexpr std::string_view toplevel_states[] = {
+			"",
+			"XDG_TOPLEVEL_STATE_MAXIMIZED",
+			"XDG_TOPLEVEL_STATE_FULLSCREEN",
+			"XDG_TOPLEVEL_STATE_RESIZING",
+			"XDG_TOPLEVEL_STATE_ACTIVATED",
+			"XDG_TOPLEVEL_STATE_TILED_LEFT",
+			"XDG_TOPLEVEL_STATE_TILED_RIGHT",
+			"XDG_TOPLEVEL_STATE_TILED_TOP",
+			"XDG_TOPLEVEL_STATE_TILED_BOTTOM",
+		};
 
-	name = (char*)malloc(strlen(path) + sizeof(templatea));
-	if (!name)
-		return -1;
-	strcpy(name, path);
-	strcat(name, templatea);
+		constexpr std::string_view decoration_modes[] = {
+			"",
+			"ZXDG_TOPLEVEL_DECORATION_V1_MODE_CLIENT_SIDE",
+			"ZXDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE",
+		};
 
-	fd = create_tmpfile_cloexec(name);
+		constexpr std::string_view seat_capabilities[] = {
+			"",
+			"POINTER",
+			"KEYBOARD",
+			"POINTER KEYBOARD",
+			"TOUCH",
+			"TOUCH POINTER",
+			"TOUCH KEYBOARD",
+			"TOUCH POINTER KEYBOARD",
+		};
 
-	free(name);
+		// Empty for values the table does not know
+		template<size_t N>
+		constexpr std::string_view Get(const std::string_view (&names)[N], uint32_t value)
+		{
+			return value < N ? names[value] : std::string_view();
+		}
 
-	if (fd < 0)
-		return -1;
+		constexpr std::string_view ShmFormat(uint32_t format)
+		{
+			for (const ShmFormatName& entry : shm_formats)
+				if (entry.format == format)
+					return entry.name;
 
-	if (ftruncate(fd, size) < 0) {
-		close(fd);
-		return -1;
+			return std::string_view();
+		}
 	}
 
-	return fd;
-}
-
-namespace Wayland
-{
-	wl_display*                 display;
-	wl_registry*                registry;
-	wl_compositor*              compositor;
-	wl_shell*                   shell;
-	xdg_wm_base*                wm_base;
-	wl_seat*                    seat;
-	wl_shm*                     shm;
-	zxdg_decoration_manager_v1* decoration_manager;
+	namespace Listeners
+	{
+		extern wl_seat_listener   wl_seat  ;
+		extern wl_output_listener wl_output;
+	}
 
 	namespace Functions
 	{
 		namespace WL_Registry
 		{
-			#define Bind(T, var)\
-				if (!strcmp(interface, #T)) \
-					var = (T*)wl_registry_bind(wl_registry, name, &T##_interface, version)
+			// Every global the client binds, sorted by name for a binary search.
+			// version is the newest one our listeners implement. A compositor
+			// advertising a newer one is bound at ours, so it never sends
+			// events we have no handler for.
+			struct Interface
+			{
+				std::string_view    name   ;
+				const wl_interface* type   ;
+				uint32_t            version;
+				void              (*bind  )(wl_registry*, uint32_t name, const wl_interface* type, uint32_t version);
+			};
+
+			// Seats get a slot each rather than a variable, since there can be several
+			static void Bind_Seat(wl_registry* wl_registry, uint32_t name, const wl_interface* type, uint32_t version)
+			{
+				wl_seat* seat  = (wl_seat*)wl_registry_bind(wl_registry, name, type, version);
+				int      index = seats.Add(seat, name);
 
-			void Global(void* data, wl_registry* wl_registry, uint32_t name, const char* interface, uint32_t version)
+				if (index < 0)
+				{
+					LOG(Warn, "Ignoring seat {}, there are already {}", name, Seats::Capacity);
+					wl_seat_destroy(seat);
+					return;
+				}
+
+				wl_seat_add_listener(seat, &Listeners::wl_seat, Seats::Data(index));
+			}
+
+			// Outputs too, windows keep the ones they are on as a bit per slot
+			static void Bind_Output(wl_registry* wl_registry, uint32_t name, const wl_interface* type, uint32_t version)
 			{
-				std::cout << fmt::format("{}: {} {}\n", name, interface, version);
+				wl_output* output = (wl_output*)wl_registry_bind(wl_registry, name, type, version);
+				int        index  = outputs.Add(output, name);
 
-				Bind(wl_compositor             , compositor        );
-				Bind(wl_shell                  , shell             );
-				Bind(wl_seat                   , seat              );
-				Bind(wl_shm                    , shm               );
-				Bind(xdg_wm_base               , wm_base           );
-				Bind(zxdg_decoration_manager_v1, decoration_manager);
+				if (index < 0)
+				{
+					LOG(Warn, "Ignoring output {}, there are already {}", name, Outputs::Capacity);
+					wl_output_destroy(output);
+					return;
+				}
+
+				wl_output_add_listener(output, &Listeners::wl_output, Outputs::Data(index));
 			}
 
+			#define Bind(T, var, version) \
+				Interface{ #T, &T##_interface, version, [](wl_registry* wl_registry, uint32_t name, const wl_interface* type, uint32_t bound) \
+				{ \
+					var = (T*)wl_registry_bind(wl_registry, name, type, bound); \
+				} }
+
+			constexpr Interface interfaces[] = {
+				Bind(wl_compositor             , compositor          , 4), // damage_buffer
+				Interface{ "wl_output", &wl_output_interface, 3, Bind_Output }, // done, scale and release
+				Interface{ "wl_seat", &wl_seat_interface, 5, Bind_Seat }, // pointer frames and axis sources
+				Bind(wl_shell                  , shell               , 1),
+				Bind(wl_shm                    , shm                 , 1),
+				Bind(wp_cursor_shape_manager_v1, cursor_shape_manager, 1),
+				Bind(wp_presentation           , presentation        , 1),
+				Bind(xdg_wm_base               , wm_base             , 2),
+				Bind(zxdg_decoration_manager_v1, decoration_manager  , 1),
+			};
+
 			#undef Bind
 
+			static_assert(std::is_sorted(std::begin(interfaces), std::end(interfaces), [](const Interface& a, const Interface& b) { return a.name < b.name; }), "Registry interfaces must be sorted by name");
+
+			void Global(void* data, wl_registry* wl_registry, uint32_t name, const char* interface, uint32_t version)
+			{
+				LOG(Debug, "{}: {} {}", name, interface, version);
+
+				std::string_view key   = interface;
+				const Interface* entry = std::lower_bound(std::begin(interfaces), std::end(interfaces), key, [](const Interface& entry, std::string_view key) { return entry.name < key; });
+
+				if (entry != std::end(interfaces) && entry->name == key)
+					entry->bind(wl_registry, name, entry->type, std::min(version, entry->version));
+			}
+
+			// Only seats and outputs are expected to come and go
 			void Global_Remove(void* data, wl_registry* wl_registry, uint32_t name)
 			{
+				if (int index = outputs.Find(name); index >= 0)
+				{
+					Output& output = outputs[index];
+					LOG(Info, "Output removed: {}", output.name);
+
+					if (wl_output_get_version(output.output) >= WL_OUTPUT_RELEASE_SINCE_VERSION)
+						wl_output_release(output.output);
+					else
+						wl_output_destroy(output.output);
+
+					outputs.Remove(index);
+
+					// Compositors send wl_surface.leave before this, but nothing makes them
+					if (input_window && (input_window->entered & Outputs::Bit(index)))
+					{
+						input_window->entered &= ~Outputs::Bit(index);
+						input_window->update_outputs();
+					}
+
+					return;
+				}
+
+				int index = seats.Find(name);
+				if (index < 0)
+					return;
+
+				Seat& seat = seats[index];
+				LOG(Info, "Seat removed: {}", seat.label);
+
+				if (input_window)
+					input_window->detach_seat(index);
+
+				if (wl_seat_get_version(seat.seat) >= WL_SEAT_RELEASE_SINCE_VERSION)
+					wl_seat_release(seat.seat);
+				else
+					wl_seat_destroy(seat.seat);
+
+				seats.Remove(index);
 			}
 		}
 
@@ -136,23 +309,96 @@ namespace Wayland
 		{
 			void Capabilities(void* data, wl_seat* wl_seat, uint32_t capabilities)
 			{
-				std::vector<std::string> strings = {
-					"",
-					"POINTER",
-					"KEYBOARD",
-					"POINTER KEYBOARD",
-					"TOUCH",
-					"TOUCH POINTER",
-					"TOUCH KEYBOARD",
-					"TOUCH POINTER KEYBOARD",
-				};
+				int index = Seats::Index(data);
 
-				std::cout << fmt::format("Seat Capabilities: {}\n", strings[capabilities]);
+				LOG(Info, "Seat Capabilities: {}", Names::Get(Names::seat_capabilities, capabilities));
+				seats[index].capabilities = capabilities;
+
+				// Before Init, the window attaches every seat itself
+				if (input_window)
+					input_window->attach_seat(index);
 			}
 
 			void Name(void* data, wl_seat* wl_seat, const char* name)
 			{
-				std::cout << fmt::format("{}\n", name);
+				Seat& seat = seats[Seats::Index(data)];
+
+				LOG(Info, "{}", name);
+				snprintf(seat.label, sizeof(seat.label), "%s", name);
+			}
+		}
+
+		// Each event goes to pending, and done applies them all at once. Before
+		// version 2 there is no done, and every event applies right away.
+		namespace WL_Output
+		{
+			void Geometry(void* data, wl_output* wl_output, int32_t x, int32_t y, int32_t physical_width, int32_t physical_height, int32_t subpixel, const char* make, const char* model, int32_t transform)
+			{
+				Output& output = outputs[Outputs::Index(data)];
+
+				output.pending.transform = transform;
+				if (!output.atomic)
+					Done(data, wl_output);
+			}
+
+			void Mode(void* data, wl_output* wl_output, uint32_t flags, int32_t width, int32_t height, int32_t refresh)
+			{
+				Output& output = outputs[Outputs::Index(data)];
+
+				// Older compositors list every mode the output has
+				if ((flags & WL_OUTPUT_MODE_CURRENT) == 0)
+					return;
+
+				output.pending.width   = width  ;
+				output.pending.height  = height ;
+				output.pending.refresh = refresh;
+				if (!output.atomic)
+					Done(data, wl_output);
+			}
+
+			void Done(void* data, wl_output* wl_output)
+			{
+				int     index  = Outputs::Index(data);
+				Output& output = outputs[index];
+
+				output.current = output.pending;
+				LOG(Info, "Output {}: {}x{} at {:.3f} Hz, scale {}, transform {}", output.name, output.current.width, output.current.height, output.current.refresh / 1000.0, output.current.scale, output.current.transform);
+
+				if (input_window && (input_window->entered & Outputs::Bit(index)))
+					input_window->update_outputs();
+			}
+
+			void Scale(void* data, wl_output* wl_output, int32_t factor)
+			{
+				outputs[Outputs::Index(data)].pending.scale = factor;
+			}
+		}
+
+		namespace WL_Surface
+		{
+			// Outputs we ignored, or that are already gone, are left out
+			void Enter(void* data, wl_surface* wl_surface, wl_output* output)
+			{
+				Window* window = (Window*)data;
+
+				int index = outputs.Find(output);
+				if (index < 0)
+					return;
+
+				window->entered |= Outputs::Bit(index);
+				window->update_outputs();
+			}
+
+			void Leave(void* data, wl_surface* wl_surface, wl_output* output)
+			{
+				Window* window = (Window*)data;
+
+				int index = outputs.Find(output);
+				if (index < 0)
+					return;
+
+				window->entered &= ~Outputs::Bit(index);
+				window->update_outputs();
 			}
 		}
 
@@ -197,30 +443,15 @@ namespace Wayland
 			{
 				Window* window = (Window*)data;
 
-				std::vector<std::string> state_strings = {
-					"",
-					"XDG_TOPLEVEL_STATE_MAXIMIZED",
-					"XDG_TOPLEVEL_STATE_FULLSCREEN",
-					"XDG_TOPLEVEL_STATE_RESIZING",
-					"XDG_TOPLEVEL_STATE_ACTIVATED",
-					"XDG_TOPLEVEL_STATE_TILED_LEFT",
-					"XDG_TOPLEVEL_STATE_TILED_RIGHT",
-					"XDG_TOPLEVEL_STATE_TILED_TOP",
-					"XDG_TOPLEVEL_STATE_TILED_BOTTOM"
-				};
-                
                 bool resizing = false;
 				
-				//std::cout << fmt::format("Size: {},{}\n", width, height);
-				//std::cout << fmt::format("State Changes: {}, {}\n", states->size, states->alloc);
+				//LOG(Debug, "Size: {},{}", width, height);
+				//LOG(Debug, "State Changes: {}, {}", states->size, states->alloc);
 				
 				const uint32_t *state;
 				WL_ARRAY_FOR_EACH(state, states, const uint32_t*)
 				{
-					std::string state_string = "";
-					if (*state < state_strings.size())
-						state_string = state_strings[*state];
-					//std::cout << fmt::format("\t{}: {}\n", *state, state_string);
+					//LOG(Debug, "\t{}: {}", *state, Names::Get(Names::toplevel_states, *state));
                     
                     if (*state == 3)
                         resizing = true;
@@ -251,13 +482,42 @@ namespace Wayland
 			}
 		}
 
+		namespace WL_Callback
+		{
+			void Frame_Done(void* data, wl_callback* wl_callback, uint32_t time)
+			{
+				Window* window = (Window*)data;
+
+				wl_callback_destroy(wl_callback);
+				window->frame_cb = nullptr;
+			}
+
+			// Animated cursors advance once per refresh of their surface, never on a timer
+			void Cursor_Done(void* data, wl_callback* wl_callback, uint32_t time)
+			{
+				int index = Seats::Index(data);
+
+				wl_callback_destroy(wl_callback);
+				seats[index].cursor_frame = nullptr;
+
+				input_window->animate_cursor(index, time);
+			}
+		}
+
 		namespace ZXDG_Toplevel_Decoration_V1
 		{
 			void Configure(void* data, zxdg_toplevel_decoration_v1* zxdg_toplevel_decoration_v1, uint32_t mode)
 			{
-				std::vector<std::string> modes = {"","ZXDG_TOPLEVEL_DECORATION_V1_MODE_CLIENT_SIDE","ZXDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE"};
-				std::string mode_string = modes[mode];
-				std::cout << fmt::format("Mode: {}\n", mode_string);
+				LOG(Info, "Mode: {}", Names::Get(Names::decoration_modes, mode));
+			}
+		}
+
+		namespace WP_Presentation
+		{
+			void Clock_Id(void* data, wp_presentation* wp_presentation, uint32_t clk_id)
+			{
+				LOG(Debug, "Presentation clock: {}", clk_id);
+				presentation_clock = clk_id;
 			}
 		}
 
@@ -265,71 +525,11 @@ namespace Wayland
 		{
 			void Format(void* data, wl_shm* wl_shm, uint32_t format)
 			{
-				std::vector<std::string> formats = {
-					"WL_SHM_FORMAT_ARGB8888",
-					"WL_SHM_FORMAT_XRGB8888",
-					"WL_SHM_FORMAT_C8",
-					"WL_SHM_FORMAT_RGB332",
-					"WL_SHM_FORMAT_BGR233",
-					"WL_SHM_FORMAT_XRGB4444",
-					"WL_SHM_FORMAT_XBGR4444",
-					"WL_SHM_FORMAT_RGBX4444",
-					"WL_SHM_FORMAT_BGRX4444",
-					"WL_SHM_FORMAT_ARGB4444",
-					"WL_SHM_FORMAT_ABGR4444",
-					"WL_SHM_FORMAT_RGBA4444",
-					"WL_SHM_FORMAT_BGRA4444",
-					"WL_SHM_FORMAT_XRGB1555",
-					"WL_SHM_FORMAT_XBGR1555",
-					"WL_SHM_FORMAT_RGBX5551",
-					"WL_SHM_FORMAT_BGRX5551",
-					"WL_SHM_FORMAT_ARGB1555",
-					"WL_SHM_FORMAT_ABGR1555",
-					"WL_SHM_FORMAT_RGBA5551",
-					"WL_SHM_FORMAT_BGRA5551",
-					"WL_SHM_FORMAT_RGB565",
-					"WL_SHM_FORMAT_BGR565",
-					"WL_SHM_FORMAT_RGB888",
-					"WL_SHM_FORMAT_BGR888",
-					"WL_SHM_FORMAT_XBGR8888",
-					"WL_SHM_FORMAT_RGBX8888",
-					"WL_SHM_FORMAT_BGRX8888",
-					"WL_SHM_FORMAT_ABGR8888",
-					"WL_SHM_FORMAT_RGBA8888",
-					"WL_SHM_FORMAT_BGRA8888",
-					"WL_SHM_FORMAT_XRGB2101010",
-					"WL_SHM_FORMAT_XBGR2101010",
-					"WL_SHM_FORMAT_RGBX1010102",
-					"WL_SHM_FORMAT_BGRX1010102",
-					"WL_SHM_FORMAT_ARGB2101010",
-					"WL_SHM_FORMAT_ABGR2101010",
-					"WL_SHM_FORMAT_RGBA1010102",
-					"WL_SHM_FORMAT_BGRA1010102",
-					"WL_SHM_FORMAT_YUYV",
-					"WL_SHM_FORMAT_YVYU",
-					"WL_SHM_FORMAT_UYVY",
-					"WL_SHM_FORMAT_VYUY",
-					"WL_SHM_FORMAT_AYUV",
-					"WL_SHM_FORMAT_NV12",
-					"WL_SHM_FORMAT_NV21",
-					"WL_SHM_FORMAT_NV16",
-					"WL_SHM_FORMAT_NV61",
-					"WL_SHM_FORMAT_YUV410",
-					"WL_SHM_FORMAT_YVU410",
-					"WL_SHM_FORMAT_YUV411",
-					"WL_SHM_FORMAT_YVU411",
-					"WL_SHM_FORMAT_YUV420",
-					"WL_SHM_FORMAT_YVU420",
-					"WL_SHM_FORMAT_YUV422",
-					"WL_SHM_FORMAT_YVU422",
-					"WL_SHM_FORMAT_YUV444",
-					"WL_SHM_FORMAT_YVU444"
-				};
-
-				if (format < formats.size())
-					std::cout << fmt::format("Format Supported: {}\n", formats[format]);
+				std::string_view name = Names::ShmFormat(format);
+				if (!name.empty())
+					LOG(Debug, "Format Supported: {}", name);
 				else
-					std::cout << fmt::format("Unknown Format: {}\n", format);
+					LOG(Debug, "Unknown Format: {}", format);
 			}
 		}
 
@@ -337,67 +537,238 @@ namespace Wayland
 		{
 			void Enter(void* data, struct wl_pointer* wl_pointer, uint32_t serial, struct wl_surface* surface, wl_fixed_t surface_x, wl_fixed_t surface_y)
 			{
-				int x = wl_fixed_to_double(surface_x);
-				int y = wl_fixed_to_double(surface_y);
+				Window*       window = input_window;
+				int           seat   = Seats::Index(data);
+				PointerFrame& frame  = window->pointer_begin(seat);
 
-				std::cout << fmt::format("Pointer enter: {},{}\n", x,y);
+				frame.changes |= PointerFrame::Enter;
+				frame.serial   = serial;
+				frame.x        = wl_fixed_to_double(surface_x);
+				frame.y        = wl_fixed_to_double(surface_y);
+
+				window->pointer_end(seat);
 			} 
 
 			void Leave(void* data, struct wl_pointer* wl_pointer, uint32_t serial, struct wl_surface* surface)
 			{
-				std::cout << fmt::format("Pointer left\n");
+				Window*       window = input_window;
+				int           seat   = Seats::Index(data);
+				PointerFrame& frame  = window->pointer_begin(seat);
+
+				frame.changes |= PointerFrame::Leave;
+				frame.serial   = serial;
+
+				window->pointer_end(seat);
 			}
 
 			void Motion(void* data, struct wl_pointer* wl_pointer, uint32_t time, wl_fixed_t surface_x, wl_fixed_t surface_y)
 			{
-				int x = wl_fixed_to_double(surface_x);
-				int y = wl_fixed_to_double(surface_y);
+				Window*       window = input_window;
+				int           seat   = Seats::Index(data);
+				PointerFrame& frame  = window->pointer_begin(seat);
+
+				frame.changes |= PointerFrame::Motion;
+				frame.time     = time;
+				frame.x        = wl_fixed_to_double(surface_x);
+				frame.y        = wl_fixed_to_double(surface_y);
+				frame.motions++;
 
-				std::cout << fmt::format("Pointer moved: {},{}\n", x,y);
+				if (window->keep_motions.load(std::memory_order_relaxed))
+					window->motion_history.Push(MotionSample{ time, frame.x, frame.y, monotonic_ns() });
+
+				window->pointer_end(seat);
 			}
 
 			void Button(void* data, struct wl_pointer* wl_pointer, uint32_t serial, uint32_t time, uint32_t button, uint32_t state)
 			{
-				Window* window = (Window*)data;
+				Window* window = input_window;
+				int     seat   = Seats::Index(data);
 
+				// Presses are never merged, a frame with more than fit is split
+				if (seats[seat].pointer_frame.button_count == PointerFrame::MaxButtons)
+					window->flush_pointer(seat);
 
-				std::cout << fmt::format("Pointer Button: {} {}\n",
-					button == BTN_LEFT ? "BTN_LEFT" : button == BTN_RIGHT ? "BTN_RIGHT" : button == BTN_MIDDLE ? "BTN_MIDDLE" : "BTN_EXTRA",
-					state == WL_POINTER_BUTTON_STATE_PRESSED ? "WL_POINTER_BUTTON_STATE_PRESSED" : "WL_POINTER_BUTTON_STATE_RELEASED"
-				);
+				PointerFrame& frame = window->pointer_begin(seat);
 
-				if (button == BTN_LEFT && state == WL_POINTER_BUTTON_STATE_PRESSED)
-				{
-				 	if (window->toplevel)
-						xdg_toplevel_move(window->toplevel, seat, serial);
-					else
-						wl_shell_surface_move(window->shell_surface, seat, serial);
-				}
+				frame.changes |= PointerFrame::Button;
+				frame.time     = time;
+				frame.buttons[frame.button_count++] = PointerFrame::Press{ button, state, serial };
+
+				window->pointer_end(seat);
 			}
 
 			void Axis(void* data, struct wl_pointer* wl_pointer, uint32_t time, uint32_t axis, wl_fixed_t value)
 			{
+				// Checked first, so an axis we do not know never starts an empty frame
+				if (axis > WL_POINTER_AXIS_HORIZONTAL_SCROLL)
+					return;
+
+				Window*       window = input_window;
+				int           seat   = Seats::Index(data);
+				PointerFrame& frame  = window->pointer_begin(seat);
+
+				frame.changes    |= PointerFrame::Axis;
+				frame.time        = time;
+				frame.axis[axis] += wl_fixed_to_double(value);
 
+				window->pointer_end(seat);
 			}
 
 			void Frame(void* data, struct wl_pointer* wl_pointer)
 			{
-
+				input_window->flush_pointer(Seats::Index(data));
 			}
 
 			void Axis_Source(void* data, struct wl_pointer* wl_pointer, uint32_t axis_source)
 			{
-
+				input_window->pointer_begin(Seats::Index(data)).axis_source = axis_source;
 			}
 
 			void Axis_Stop(void* data, struct wl_pointer* wl_pointer, uint32_t time, uint32_t axis)
 			{
+				Window*       window = input_window;
+				int           seat   = Seats::Index(data);
+				PointerFrame& frame  = window->pointer_begin(seat);
 
+				frame.changes |= PointerFrame::Axis_Stop;
+				frame.time     = time;
 			}
 
 			void Axis_Discrete(void* data, struct wl_pointer* wl_pointer, uint32_t axis, int32_t discrete)
 			{
+				if (axis > WL_POINTER_AXIS_HORIZONTAL_SCROLL)
+					return;
+
+				Window*       window = input_window;
+				int           seat   = Seats::Index(data);
+				PointerFrame& frame  = window->pointer_begin(seat);
+
+				frame.discrete[axis] += discrete;
+			}
+		}
+
+		namespace WL_Touch
+		{
+			// Contacts are updated in place in their seat's touch_frame, which
+			// wl_touch.frame hands on whole
+			void Down(void* data, struct wl_touch* wl_touch, uint32_t serial, uint32_t time, struct wl_surface* surface, int32_t id, wl_fixed_t x, wl_fixed_t y)
+			{
+				int                  index   = Seats::Index(data);
+				TouchFrame::Contact* contact = input_window->touch_contact(index, id, true);
+
+				if (contact == nullptr)
+					return;
+
+				contact->phase = TouchFrame::Down;
+				contact->x     = wl_fixed_to_double(x);
+				contact->y     = wl_fixed_to_double(y);
+
+				seats[index].touch_frame.time = time;
+			}
+
+			void Up(void* data, struct wl_touch* wl_touch, uint32_t serial, uint32_t time, int32_t id)
+			{
+				int                  index   = Seats::Index(data);
+				TouchFrame::Contact* contact = input_window->touch_contact(index, id, false);
+
+				if (contact == nullptr)
+					return;
+
+				contact->phase = TouchFrame::Up;
+
+				seats[index].touch_frame.time = time;
+			}
+
+			void Motion(void* data, struct wl_touch* wl_touch, uint32_t time, int32_t id, wl_fixed_t x, wl_fixed_t y)
+			{
+				int                  index   = Seats::Index(data);
+				TouchFrame::Contact* contact = input_window->touch_contact(index, id, false);
+
+				if (contact == nullptr)
+					return;
+
+				// Down in the same frame stays down, just somewhere else
+				if (contact->phase == TouchFrame::Held)
+					contact->phase = TouchFrame::Motion;
+
+				contact->x = wl_fixed_to_double(x);
+				contact->y = wl_fixed_to_double(y);
+
+				seats[index].touch_frame.time = time;
+			}
+
+			void Frame(void* data, struct wl_touch* wl_touch)
+			{
+				input_window->flush_touch(Seats::Index(data));
+			}
+
+			void Cancel(void* data, struct wl_touch* wl_touch)
+			{
+				int         index = Seats::Index(data);
+				TouchFrame& frame = seats[index].touch_frame;
+
+				for (TouchFrame::Contact& contact : frame.contacts)
+					if (contact.id >= 0)
+						contact.phase = TouchFrame::Cancelled;
+
+				if (frame.received == 0)
+					frame.received = monotonic_ns();
+
+				input_window->flush_touch(index);
+			}
+		}
+
+		namespace WL_Keyboard
+		{
+			void Keymap(void* data, struct wl_keyboard* wl_keyboard, uint32_t format, int32_t fd, uint32_t size)
+			{
+				Seat& seat = seats[Seats::Index(data)];
+
+				if (format != WL_KEYBOARD_KEYMAP_FORMAT_XKB_V1)
+				{
+					LOG(Info, "{}: No keymap, keys only have their codes", seat.label);
+					seat.keymap.Destroy();
+				}
+				else if (!seat.keymap.Load(fd, size))
+					LOG(Warn, "{}: Could not compile the keymap, keys only have their codes", seat.label);
+
+				close(fd);
+			}
+
+			void Enter(void* data, struct wl_keyboard* wl_keyboard, uint32_t serial, struct wl_surface* surface, wl_array* keys)
+			{
+				input_window->key_event(KeyEvent{ .seat = Seats::Index(data), .type = KeyEvent::Enter });
+			}
+
+			void Leave(void* data, struct wl_keyboard* wl_keyboard, uint32_t serial, struct wl_surface* surface)
+			{
+				input_window->key_event(KeyEvent{ .seat = Seats::Index(data), .type = KeyEvent::Leave });
+			}
+
+			void Key(void* data, struct wl_keyboard* wl_keyboard, uint32_t serial, uint32_t time, uint32_t key, uint32_t state)
+			{
+				int      index = Seats::Index(data);
+				Seat&    seat  = seats[index];
+				KeyEvent event { .seat = index, .type = KeyEvent::Key, .time = time, .key = key, .state = state };
 
+				seat.keymap.Translate(key, event);
+				event.modifiers = seat.keymap.Modifiers();
+
+				input_window->key_event(event);
+			}
+
+			void Modifiers(void* data, struct wl_keyboard* wl_keyboard, uint32_t serial, uint32_t mods_depressed, uint32_t mods_latched, uint32_t mods_locked, uint32_t group)
+			{
+				int   index = Seats::Index(data);
+				Seat& seat  = seats[index];
+
+				seat.keymap.SetModifiers(mods_depressed, mods_latched, mods_locked, group);
+				input_window->key_event(KeyEvent{ .seat = index, .type = KeyEvent::Modifiers, .modifiers = seat.keymap.Modifiers() });
+			}
+
+			void Repeat_Info(void* data, struct wl_keyboard* wl_keyboard, int32_t rate, int32_t delay)
+			{
+				input_window->key_event(KeyEvent{ .seat = Seats::Index(data), .type = KeyEvent::Repeat_Info, .rate = rate, .delay = delay });
 			}
 		}
 	}
@@ -416,6 +787,20 @@ namespace Wayland
 			.name = Functions::WL_Seat::Name
 		};
 
+		wl_output_listener wl_output
+		{
+			.geometry = Functions::WL_Output::Geometry,
+			.mode     = Functions::WL_Output::Mode,
+			.done     = Functions::WL_Output::Done,
+			.scale    = Functions::WL_Output::Scale
+		};
+
+		wl_surface_listener wl_surface
+		{
+			.enter = Functions::WL_Surface::Enter,
+			.leave = Functions::WL_Surface::Leave
+		};
+
 		wl_shell_surface_listener wl_shell_surface
 		{
 			.ping = Functions::WL_Shell_Surface::Ping,
@@ -438,11 +823,26 @@ namespace Wayland
 			.close = Functions::XDG_Toplevel::Close
 		};
 
+		wl_callback_listener wl_callback_frame
+		{
+			.done = Functions::WL_Callback::Frame_Done
+		};
+
+		wl_callback_listener wl_callback_cursor
+		{
+			.done = Functions::WL_Callback::Cursor_Done
+		};
+
 		zxdg_toplevel_decoration_v1_listener zxdg_toplevel_decoration_v1
 		{
 			.configure = Functions::ZXDG_Toplevel_Decoration_V1::Configure,
 		};
 
+		wp_presentation_listener wp_presentation
+		{
+			.clock_id = Functions::WP_Presentation::Clock_Id
+		};
+
 		wl_shm_listener wl_shm
 		{
 			.format = Functions::WL_Shm::Format
@@ -460,6 +860,25 @@ namespace Wayland
 			Functions::WL_Pointer::Axis_Stop,
 			Functions::WL_Pointer::Axis_Discrete
 		};
+
+		wl_touch_listener wl_touch
+		{
+			.down   = Functions::WL_Touch::Down,
+			.up     = Functions::WL_Touch::Up,
+			.motion = Functions::WL_Touch::Motion,
+			.frame  = Functions::WL_Touch::Frame,
+			.cancel = Functions::WL_Touch::Cancel
+		};
+
+		wl_keyboard_listener wl_keyboard
+		{
+			.keymap      = Functions::WL_Keyboard::Keymap,
+			.enter       = Functions::WL_Keyboard::Enter,
+			.leave       = Functions::WL_Keyboard::Leave,
+			.key         = Functions::WL_Keyboard::Key,
+			.modifiers   = Functions::WL_Keyboard::Modifiers,
+			.repeat_info = Functions::WL_Keyboard::Repeat_Info
+		};
 	}
 
 	void Window::SetupStatics()
@@ -468,27 +887,40 @@ namespace Wayland
 		if (display == nullptr)
 			throw std::runtime_error("No display found");
 
+		event_loop.Init(display);
+
 		registry = wl_display_get_registry(display);
 
 		wl_registry_add_listener(registry, &Listeners::wl_registry, nullptr);
 		wl_display_roundtrip(display);
 
 		if (compositor == nullptr                      ) throw std::runtime_error("No compositor found");
-		if (seat       == nullptr                      ) throw std::runtime_error("No seat found"      );
 		if (shm        == nullptr                      ) throw std::runtime_error("No shm found"       );
 		if (shell      == nullptr && wm_base == nullptr) throw std::runtime_error("No shell found"     );
 
 		if (wm_base != nullptr)
 			xdg_wm_base_add_listener(wm_base, &Listeners::xdg_wm_base, nullptr);
 
-		wl_seat_add_listener(seat, &Listeners::wl_seat, nullptr);
 		wl_shm_add_listener(shm, &Listeners::wl_shm, nullptr);
+
+		if (presentation != nullptr)
+			wp_presentation_add_listener(presentation, &Listeners::wp_presentation, nullptr);
+
+		cursors.Init(shm);
+	}
+
+	// The cursor themes' buffers are only freed once no cursor surface shows them
+	void Window::DestroyStatics()
+	{
+		cursors.Destroy();
+		wl_display_flush(display);
 	}
 
 	void Window::Init(int width, int height, int x, int y, bool show, Window* parent, bool noDecoration, bool noTaskbarIcon, bool topmost)
 	{
 		// create a surface
 		surface_wl = wl_compositor_create_surface(compositor);
+		wl_surface_add_listener(surface_wl, &Listeners::wl_surface, this);
 
 		// create a shell surface
 		if(wm_base)
@@ -517,9 +949,51 @@ namespace Wayland
 			zxdg_toplevel_decoration_v1_set_mode(toplevel_decoration, ZXDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE);
 		}
 
-		pointer = wl_seat_get_pointer(seat);
+		swapchain.Init(shm);
+
+		// Seats that arrive later attach themselves when they send their capabilities
+		input_window = this;
+
+		if (input_threaded)
+			input.Init(display);
+
+		repeat_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+		if (repeat_fd < 0)
+			throw std::runtime_error(fmt::format("Could not create the key repeat timer: {}", strerror(errno)));
+
+		event_loop.AddFd(repeat_fd, EPOLLIN, [this](uint32_t events)
+		{
+			repeat();
+		});
+
+		frame_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+		if (frame_fd < 0)
+			throw std::runtime_error(fmt::format("Could not create the frame timer: {}", strerror(errno)));
+
+		// Only wakes the loop, the Poll after it draws the frame
+		event_loop.AddFd(frame_fd, EPOLLIN, [this](uint32_t events)
+		{
+			uint64_t count;
+			while (read(frame_fd, &count, sizeof(count)) < 0 && errno == EINTR);
+		});
+
+		for (int a = 0; a < seats.Used(); a++)
+			if (seats[a].name != 0)
+				attach_seat(a);
+
+		if (input_threaded)
+		{
+			// Events that arrive while we wait for a frame are handled right away
+			event_loop.AddFd(input.WakeFd(), EPOLLIN, [this](uint32_t events)
+			{
+				uint64_t count;
+				while (read(input.WakeFd(), &count, sizeof(count)) < 0 && errno == EINTR);
+
+				drain_input();
+			});
 
-		wl_pointer_add_listener(pointer, &Listeners::wl_pointer, this);
+			input.Start();
+		}
 
 		this->x      = x     ;
 		this->y      = y     ;
@@ -529,61 +1003,852 @@ namespace Wayland
 		wl_surface_commit(surface_wl);
 		wl_display_roundtrip(display);
 
+		// The presentation clock has arrived by now, it is sent when the global is bound
+		feedback.Init(presentation, presentation_clock);
+
 		isOpen = true;
 	}
 
-	void* Window::GetWindowHandler()
+	void Window::Destroy()
 	{
-		return surface_wl;
+		// The input thread's listeners use the seats, so their devices go
+		// before it stops, and the queue they were on goes with it
+		for (int a = 0; a < seats.Used(); a++)
+			if (seats[a].name != 0)
+				detach_seat(a);
+
+		if (input_threaded)
+			event_loop.RemoveFd(input.WakeFd());
+
+		input.Stop();
+
+		event_loop.RemoveFd(repeat_fd);
+		event_loop.RemoveFd(frame_fd );
+		close(repeat_fd);
+		close(frame_fd );
+		repeat_fd = -1;
+		frame_fd  = -1;
+
+		// Feedback still waiting for an answer would never get one
+		feedback.Destroy();
+
+		if (frame_cb           ) wl_callback_destroy                (frame_cb           );
+		if (toplevel_decoration) zxdg_toplevel_decoration_v1_destroy(toplevel_decoration);
+		if (toplevel           ) xdg_toplevel_destroy               (toplevel           );
+		if (surface_xdg        ) xdg_surface_destroy                (surface_xdg        );
+		if (shell_surface      ) wl_shell_surface_destroy           (shell_surface      );
+		swapchain.Destroy();
+		wl_surface_destroy(surface_wl);
+		wl_display_flush(display);
+
+		frame_cb            = nullptr;
+		toplevel_decoration = nullptr;
+		toplevel            = nullptr;
+		surface_xdg         = nullptr;
+		shell_surface       = nullptr;
+		surface_wl          = nullptr;
+		isOpen              = false  ;
+
+		if (input_window == this)
+			input_window = nullptr;
 	}
 
-	void Window::Poll()
-	{
-        wl_display_roundtrip(display);
-        
-        if (resized)
-        {            
-            create_buffer();
-
-			const int OFFSET_RED   = 2;
-			const int OFFSET_GREEN = 1;
-			const int OFFSET_BLUE  = 0;
-			const int OFFSET_ALPHA = 3;
-            
-            for (int x = 0; x < width; x++)
-            {
-                for (int y = 0; y < height; y++)
-                {
-					int offset = (x + y * width) * 4;
-
-                    shm_data[offset + OFFSET_RED  ] = (x / (float)width ) * 256;
-                    shm_data[offset + OFFSET_GREEN] = (y / (float)height) * 256;
-                    shm_data[offset + OFFSET_BLUE ] = 0x00;
-                    shm_data[offset + OFFSET_ALPHA] = 0xFF; //rand() % 256;
-                }
-            }
-
-            wl_surface_attach(surface_wl, shm_buffer, x, y);
-            wl_surface_damage(surface_wl, 0, 0, width, height);
-            wl_surface_commit(surface_wl);
-            
-            resized = false;
-        }
-	}
-
-	bool Window::IsOpen()
+	void* Window::GetWindowHandler()
 	{
-		return isOpen;
+		return surface_wl;
 	}
 
-	void Window::ChangeWindowText(std::string text)
+	void Window::Poll(int timeout)
 	{
-	}
+		drain_input();
 
-	void Window::SetSize(int width, int height)
-	{
-	}
-	
+		// Only draw once the compositor has asked for the next frame, so we
+		// never render more frames than the output refreshes. A resize is not
+		// held back for the scheduler, the compositor is waiting on it.
+		uint64_t start = 0;
+		if ((resized || redraw) && frame_cb == nullptr && (resized || frame_ready(start)))
+		{
+			// Creating buffers is not what a frame usually costs
+			bool measure = !resized;
+
+			if (resized)
+			{
+				create_buffer();
+
+				// The fill never has alpha, so the whole surface is opaque at its new size
+				wl_region* region = wl_compositor_create_region(compositor);
+				wl_region_add(region, 0, 0, width, height);
+				wl_surface_set_opaque_region(surface_wl, region);
+				wl_region_destroy(region);
+
+				if (wl_surface_get_version(surface_wl) >= WL_SURFACE_SET_BUFFER_SCALE_SINCE_VERSION)
+					wl_surface_set_buffer_scale(surface_wl, scale);
+			}
+
+			// nullptr while every buffer is still held by the compositor, its
+			// release wakes the dispatch below and we try again
+			Buffer* buffer = swapchain.Acquire();
+			if (buffer != nullptr)
+			{
+				// Red grows to the right, green grows downwards
+				Fill::Bilinear((uint32_t*)buffer->data, buffer->width, buffer->height, buffer->stride, 0xFF000000, 0xFFFF0000, 0xFF00FF00, 0xFFFFFF00);
+				buffer->damage.Clear();
+
+				frame_cb = wl_surface_frame(surface_wl);
+				wl_callback_add_listener(frame_cb, &Listeners::wl_callback_frame, this);
+
+				wl_surface_attach(surface_wl, buffer->buffer, x, y);
+				wl_surface_damage(surface_wl, 0, 0, width, height);
+				feedback.Commit(surface_wl);
+
+				if (measure)
+					scheduler.Measure(start, feedback.Now());
+
+				wl_surface_commit(surface_wl);
+				buffer->busy = true;
+
+				// Only now, a resize that found no free buffer is retried
+				resized   = false;
+				redraw    = false;
+				frame_due = 0    ;
+			}
+		}
+
+		// Sleeps until the compositor or another fd on the loop wakes us, frame callbacks included
+		if (!event_loop.Dispatch(timeout))
+			isOpen = false;
+	}
+
+	void Window::Redraw()
+	{
+		redraw = true;
+	}
+
+	bool Window::frame_ready(uint64_t& start)
+	{
+		uint64_t now = feedback.Now();
+
+		// Decided once per frame, so waking a little after frame_due does not
+		// push the frame back to the refresh after
+		if (frame_due == 0)
+		{
+			FrameTiming last;
+			bool        known = scheduling && feedback.Last(last);
+
+			// On another output the last frame's phase means nothing, so the
+			// first frame there is drawn straight away and its feedback has the new one
+			if (known && last.output && entered && sync_output() != outputs.Find(last.output))
+				known = false;
+
+			if (!known)
+				frame_due = now;
+			else
+			{
+				scheduler.Presented(last);
+				frame_due = scheduler.Next(last, now);
+			}
+
+			if (frame_due > now)
+			{
+				// timerfds only take CLOCK_MONOTONIC here, which the presentation clock may not be
+				uint64_t   at    = monotonic_ns() + (frame_due - now);
+				itimerspec timer = {};
+				timer.it_value.tv_sec  = at / 1000000000;
+				timer.it_value.tv_nsec = at % 1000000000;
+				timerfd_settime(frame_fd, TFD_TIMER_ABSTIME, &timer, nullptr);
+			}
+		}
+
+		if (now < frame_due)
+			return false;
+
+		// Measured from when it was due, so the time it took to wake up counts too
+		start = frame_due;
+		return true;
+	}
+
+	// Buffers are drawn for the densest output the surface is on, so one that
+	// only sits on 1x outputs never pays for 2x buffers. Off every output it
+	// is not shown at all, and keeps what it had.
+	void Window::update_outputs()
+	{
+		if (entered == 0)
+			return;
+
+		int scale = 1;
+		for (int a = 0; a < outputs.Used(); a++)
+			if (entered & Outputs::Bit(a))
+				scale = std::max(scale, outputs[a].current.scale);
+
+		// Before version 3 the compositor cannot be told, and takes every buffer as 1x
+		if (wl_surface_get_version(surface_wl) < WL_SURFACE_SET_BUFFER_SCALE_SINCE_VERSION)
+			scale = 1;
+
+		if (scale == this->scale)
+			return;
+
+		LOG(Info, "Scale: {}", scale);
+		this->scale = scale;
+		resized     = true ;
+
+		// Cursors we draw are loaded again for it, the compositor scales its own
+		for (int a = 0; a < seats.Used(); a++)
+			if (seats[a].cursor_device == nullptr)
+				show_cursor(a);
+	}
+
+	int Window::sync_output()
+	{
+		FrameTiming last;
+		if (feedback.Last(last))
+		{
+			int index = outputs.Find(last.output);
+			if (index >= 0 && (entered & Outputs::Bit(index)))
+				return index;
+		}
+
+		// Until feedback says which, the fastest output is the one to keep up with
+		int fastest = -1;
+		for (int a = 0; a < outputs.Used(); a++)
+			if ((entered & Outputs::Bit(a)) && (fastest < 0 || outputs[a].current.refresh > outputs[fastest].current.refresh))
+				fastest = a;
+
+		return fastest;
+	}
+
+	// Each event is folded into its seat's pointer_frame, which
+	// wl_pointer.frame hands on as one. Before version 5 there are no frame
+	// events, and every event is a frame of its own.
+	PointerFrame& Window::pointer_begin(int seat)
+	{
+		PointerFrame& frame = seats[seat].pointer_frame;
+		if (frame.received == 0)
+		{
+			frame.seat     = seat;
+			frame.received = monotonic_ns();
+		}
+
+		return frame;
+	}
+
+	void Window::pointer_end(int seat)
+	{
+		if (!seats[seat].pointer_frames)
+			flush_pointer(seat);
+	}
+
+	void Window::flush_pointer(int seat)
+	{
+		PointerFrame& frame = seats[seat].pointer_frame;
+		if (frame.received == 0) // nothing since the last frame
+			return;
+
+		if (input_threaded)
+			input.Push(frame);
+		else
+			handle_pointer(frame);
+
+		frame = {};
+	}
+
+	// Both under the input lock, the input thread may be in one of their listeners
+	static void release_pointer(Seat& seat)
+	{
+		if (wl_pointer_get_version(seat.pointer) >= WL_POINTER_RELEASE_SINCE_VERSION)
+			wl_pointer_release(seat.pointer);
+		else
+			wl_pointer_destroy(seat.pointer);
+
+		if (seat.cursor_device ) wp_cursor_shape_device_v1_destroy(seat.cursor_device );
+		if (seat.cursor_frame  ) wl_callback_destroy              (seat.cursor_frame  );
+		if (seat.cursor_surface) wl_surface_destroy               (seat.cursor_surface);
+
+		seat.pointer        = nullptr;
+		seat.pointer_frame  = {};
+		seat.cursor_device  = nullptr;
+		seat.cursor_frame   = nullptr;
+		seat.cursor_surface = nullptr;
+		seat.cursor         = nullptr;
+		seat.cursor_serial  = 0;
+	}
+
+	static void release_keyboard(Seat& seat)
+	{
+		if (wl_keyboard_get_version(seat.keyboard) >= WL_KEYBOARD_RELEASE_SINCE_VERSION)
+			wl_keyboard_release(seat.keyboard);
+		else
+			wl_keyboard_destroy(seat.keyboard);
+
+		seat.keyboard = nullptr;
+		seat.keymap.Destroy();
+	}
+
+	static void release_touch(Seat& seat)
+	{
+		if (wl_touch_get_version(seat.touch) >= WL_TOUCH_RELEASE_SINCE_VERSION)
+			wl_touch_release(seat.touch);
+		else
+			wl_touch_destroy(seat.touch);
+
+		seat.touch       = nullptr;
+		seat.touch_frame = {};
+	}
+
+	void Window::attach_seat(int index)
+	{
+		Seat& seat = seats[index];
+
+		bool has_pointer  = seat.capabilities & WL_SEAT_CAPABILITY_POINTER;
+		bool has_keyboard = seat.capabilities & WL_SEAT_CAPABILITY_KEYBOARD;
+		bool has_touch    = seat.capabilities & WL_SEAT_CAPABILITY_TOUCH;
+
+		if (has_pointer == (seat.pointer != nullptr) && has_keyboard == (seat.keyboard != nullptr) && has_touch == (seat.touch != nullptr))
+			return;
+
+		{
+			std::unique_lock<std::mutex> lock = input.Lock();
+
+			// Created through a wrapper, devices and every event they get
+			// live on the input queue
+			wl_seat* source = seat.seat;
+			if (input_threaded)
+			{
+				source = (wl_seat*)wl_proxy_create_wrapper(seat.seat);
+				wl_proxy_set_queue((wl_proxy*)source, input.Queue());
+			}
+
+			if (has_pointer && seat.pointer == nullptr)
+			{
+				seat.pointer        = wl_seat_get_pointer(source);
+				seat.pointer_frames = wl_pointer_get_version(seat.pointer) >= WL_POINTER_FRAME_SINCE_VERSION;
+				wl_pointer_add_listener(seat.pointer, &Listeners::wl_pointer, Seats::Data(index));
+
+				if (cursor_shape_manager)
+					seat.cursor_device = wp_cursor_shape_manager_v1_get_pointer(cursor_shape_manager, seat.pointer);
+			}
+
+			if (has_keyboard && seat.keyboard == nullptr)
+			{
+				seat.keyboard = wl_seat_get_keyboard(source);
+				wl_keyboard_add_listener(seat.keyboard, &Listeners::wl_keyboard, Seats::Data(index));
+			}
+
+			if (has_touch && seat.touch == nullptr)
+			{
+				seat.touch = wl_seat_get_touch(source);
+				wl_touch_add_listener(seat.touch, &Listeners::wl_touch, Seats::Data(index));
+			}
+
+			if (input_threaded)
+				wl_proxy_wrapper_destroy(source);
+
+			if (!has_pointer  && seat.pointer ) release_pointer (seat);
+			if (!has_keyboard && seat.keyboard) release_keyboard(seat);
+			if (!has_touch    && seat.touch   ) release_touch   (seat);
+		}
+
+		// Events they sent before they went still count
+		drain_input();
+
+		if (!has_pointer ) seat.pointer_data = {};
+		if (!has_keyboard) stop_repeat(index);
+		if (!has_touch   ) seat.touch_data = {};
+	}
+
+	void Window::detach_seat(int index)
+	{
+		Seat& seat = seats[index];
+
+		{
+			std::unique_lock<std::mutex> lock = input.Lock();
+
+			if (seat.pointer ) release_pointer (seat);
+			if (seat.keyboard) release_keyboard(seat);
+			if (seat.touch   ) release_touch   (seat);
+		}
+
+		drain_input();
+
+		seat.pointer_data = {};
+		seat.touch_data   = {};
+		stop_repeat(index);
+	}
+
+	TouchFrame::Contact* Window::touch_contact(int seat, int32_t id, bool down)
+	{
+		TouchFrame& frame = seats[seat].touch_frame;
+		if (frame.received == 0)
+		{
+			frame.seat     = seat;
+			frame.received = monotonic_ns();
+		}
+
+		TouchFrame::Contact* free = nullptr;
+		for (TouchFrame::Contact& contact : frame.contacts)
+		{
+			if (contact.id == id)
+				return &contact;
+
+			if (contact.id < 0 && free == nullptr)
+				free = &contact;
+		}
+
+		if (!down || free == nullptr)
+			return nullptr;
+
+		free->id = id;
+		return free;
+	}
+
+	void Window::flush_touch(int seat)
+	{
+		TouchFrame& frame = seats[seat].touch_frame;
+		if (frame.received == 0) // nothing since the last frame
+			return;
+
+		if (input_threaded)
+			input.Push(frame);
+		else
+			handle_touch(frame);
+
+		// Contacts that ended free their slots, the rest carry over as they are
+		for (TouchFrame::Contact& contact : frame.contacts)
+		{
+			if (contact.phase == TouchFrame::Up || contact.phase == TouchFrame::Cancelled)
+				contact = {};
+			else
+				contact.phase = TouchFrame::Held;
+		}
+
+		frame.received = 0;
+	}
+
+	void Window::key_event(const KeyEvent& event)
+	{
+		KeyEvent stamped = event;
+		stamped.received = monotonic_ns();
+
+		if (input_threaded)
+			input.Push(stamped);
+		else
+			handle_key(stamped);
+	}
+
+	void Window::drain_input()
+	{
+		if (!input_threaded)
+			return;
+
+		// Frames that only moved the pointer fold into the next one, so a
+		// backlog costs one handle per click or scroll rather than one per
+		// report from the mouse
+		PointerFrame frame;
+		PointerFrame held;
+		bool         holding = false;
+
+		while (input.Pop(frame))
+		{
+			if (holding && held.seat == frame.seat && held.changes == PointerFrame::Motion && frame.changes == PointerFrame::Motion)
+			{
+				held.time     = frame.time;
+				held.x        = frame.x;
+				held.y        = frame.y;
+				held.motions += frame.motions;
+				continue;
+			}
+
+			if (holding)
+				handle_pointer(held);
+
+			held    = frame;
+			holding = true;
+		}
+
+		if (holding)
+			handle_pointer(held);
+
+		KeyEvent key;
+		while (input.Pop(key))
+			handle_key(key);
+
+		// Touch frames where contacts only moved fold the same way, keeping
+		// which contacts moved at all
+		auto moves_only = [](const TouchFrame& frame)
+		{
+			for (const TouchFrame::Contact& contact : frame.contacts)
+				if (contact.phase != TouchFrame::Held && contact.phase != TouchFrame::Motion)
+					return false;
+
+			return true;
+		};
+
+		TouchFrame touch;
+		TouchFrame held_touch;
+		bool       holding_touch = false;
+
+		while (input.Pop(touch))
+		{
+			if (holding_touch && held_touch.seat == touch.seat && moves_only(held_touch) && moves_only(touch))
+			{
+				for (int a = 0; a < TouchFrame::MaxContacts; a++)
+					if (held_touch.contacts[a].phase == TouchFrame::Motion)
+						touch.contacts[a].phase = TouchFrame::Motion;
+
+				touch.received = held_touch.received;
+				held_touch     = touch;
+				continue;
+			}
+
+			if (holding_touch)
+				handle_touch(held_touch);
+
+			held_touch    = touch;
+			holding_touch = true;
+		}
+
+		if (holding_touch)
+			handle_touch(held_touch);
+	}
+
+	void Window::handle_pointer(const PointerFrame& frame)
+	{
+		Seat&        seat        = seats[frame.seat];
+		PointerData& pointerData = seat.pointer_data;
+
+		if (frame.changes & PointerFrame::Leave)
+		{
+			LOG(Debug, "{}: Pointer left", seat.label);
+			pointerData = {};
+
+			// The surface is kept for the next enter, only the animation stops
+			seat.cursor_serial = 0;
+			if (seat.cursor_frame)
+			{
+				wl_callback_destroy(seat.cursor_frame);
+				seat.cursor_frame = nullptr;
+			}
+		}
+
+		if (frame.changes & PointerFrame::Enter)
+		{
+			LOG(Debug, "{}: Pointer enter: {},{}", seat.label, (int)frame.x, (int)frame.y);
+
+			seat.cursor_serial = frame.serial;
+			show_cursor(frame.seat);
+		}
+
+		if (frame.changes & PointerFrame::Motion)
+			LOG(Trace, "{}: Pointer moved: {},{} ({} motions)", seat.label, (int)frame.x, (int)frame.y, frame.motions);
+
+		if (frame.changes & (PointerFrame::Enter | PointerFrame::Motion))
+		{
+			pointerData.xPos = frame.x;
+			pointerData.yPos = frame.y;
+		}
+
+		for (int a = 0; a < frame.button_count; a++)
+		{
+			const PointerFrame::Press& press   = frame.buttons[a];
+			bool                       pressed = press.state == WL_POINTER_BUTTON_STATE_PRESSED;
+
+			LOG(Debug, "{}: Pointer Button: {} {}", seat.label,
+				press.button == BTN_LEFT ? "BTN_LEFT" : press.button == BTN_RIGHT ? "BTN_RIGHT" : press.button == BTN_MIDDLE ? "BTN_MIDDLE" : "BTN_EXTRA",
+				pressed ? "WL_POINTER_BUTTON_STATE_PRESSED" : "WL_POINTER_BUTTON_STATE_RELEASED"
+			);
+
+			switch (press.button)
+			{
+				case BTN_LEFT  : pointerData.left   = pressed; break;
+				case BTN_MIDDLE: pointerData.middle = pressed; break;
+				case BTN_RIGHT : pointerData.right  = pressed; break;
+			}
+
+			if (press.button == BTN_LEFT && pressed)
+			{
+			 	if (toplevel)
+					xdg_toplevel_move(toplevel, seat.seat, press.serial);
+				else
+					wl_shell_surface_move(shell_surface, seat.seat, press.serial);
+			}
+		}
+
+		if (frame.changes & PointerFrame::Axis)
+			LOG(Debug, "{}: Pointer Axis: {} {} ({} {} clicks)", seat.label, frame.axis[WL_POINTER_AXIS_VERTICAL_SCROLL], frame.axis[WL_POINTER_AXIS_HORIZONTAL_SCROLL],
+				frame.discrete[WL_POINTER_AXIS_VERTICAL_SCROLL], frame.discrete[WL_POINTER_AXIS_HORIZONTAL_SCROLL]);
+	}
+
+	void Window::handle_key(const KeyEvent& event)
+	{
+		Seat& seat = seats[event.seat];
+
+		switch (event.type)
+		{
+			case KeyEvent::Enter:
+				LOG(Debug, "{}: Keyboard enter", seat.label);
+				break;
+
+			case KeyEvent::Leave:
+				LOG(Debug, "{}: Keyboard left", seat.label);
+				stop_repeat(event.seat);
+				break;
+
+			case KeyEvent::Key:
+			case KeyEvent::Repeat:
+			{
+				bool pressed = event.state == WL_KEYBOARD_KEY_STATE_PRESSED;
+
+				LOG(Debug, "{}: Key {} {:#06x} \"{}\" {}{} after {}us", seat.label, event.key, event.sym, event.text,
+					pressed ? "pressed" : "released", event.type == KeyEvent::Repeat ? " again" : "", (monotonic_ns() - event.received) / 1000);
+
+				if (event.type == KeyEvent::Repeat)
+					break;
+
+				if (pressed && event.repeats && seat.repeat_rate > 0)
+				{
+					repeat_key = event;
+					repeating  = true ;
+
+					itimerspec timer = {};
+					timer.it_value   .tv_sec  =  seat.repeat_delay / 1000;
+					timer.it_value   .tv_nsec = (seat.repeat_delay % 1000) * 1000000L;
+					timer.it_interval.tv_nsec = 1000000000L / seat.repeat_rate;
+					if (timer.it_interval.tv_nsec >= 1000000000L) // a rate of one a second
+					{
+						timer.it_interval.tv_sec  = 1;
+						timer.it_interval.tv_nsec = 0;
+					}
+
+					timerfd_settime(repeat_fd, 0, &timer, nullptr);
+				}
+				else if (!pressed && repeating && repeat_key.seat == event.seat && repeat_key.key == event.key)
+					stop_repeat(event.seat);
+				break;
+			}
+
+			case KeyEvent::Modifiers:
+				LOG(Trace, "{}: Modifiers {:#x}", seat.label, event.modifiers);
+				break;
+
+			case KeyEvent::Repeat_Info:
+				seat.repeat_rate  = event.rate ;
+				seat.repeat_delay = event.delay;
+				break;
+		}
+	}
+
+	void Window::handle_touch(const TouchFrame& frame)
+	{
+		Seat& seat = seats[frame.seat];
+
+		for (const TouchFrame::Contact& contact : frame.contacts)
+		{
+			switch (contact.phase)
+			{
+				case TouchFrame::Down:
+					LOG(Debug, "{}: Touch {} down: {},{}", seat.label, contact.id, (int)contact.x, (int)contact.y);
+					break;
+
+				case TouchFrame::Motion:
+					LOG(Trace, "{}: Touch {} moved: {},{}", seat.label, contact.id, (int)contact.x, (int)contact.y);
+					break;
+
+				case TouchFrame::Up:
+					LOG(Debug, "{}: Touch {} up", seat.label, contact.id);
+					break;
+
+				case TouchFrame::Cancelled:
+					LOG(Debug, "{}: Touch {} cancelled", seat.label, contact.id);
+					break;
+
+				case TouchFrame::Held:
+					break;
+			}
+		}
+
+		seat.touch_data = frame;
+	}
+
+	// Ours, in the compositor's terms
+	static constexpr uint32_t cursor_shapes[Cursors::Shapes] =
+	{
+		WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_DEFAULT    ,
+		WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_POINTER    ,
+		WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_TEXT       ,
+		WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_WAIT       ,
+		WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_CROSSHAIR  ,
+		WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_MOVE       ,
+		WP_CURSOR_SHAPE_DEVICE_V1_SHAPE_NOT_ALLOWED,
+	};
+
+	void Window::show_cursor(int index)
+	{
+		Seat& seat = seats[index];
+		if (seat.pointer == nullptr || seat.cursor_serial == 0)
+			return;
+
+		// The compositor draws it, animation included, and no theme is ever loaded
+		if (seat.cursor_device)
+		{
+			wp_cursor_shape_device_v1_set_shape(seat.cursor_device, seat.cursor_serial, cursor_shapes[seat.cursor_shape]);
+			return;
+		}
+
+		// Without a theme the compositor's cursor is left as it is
+		wl_cursor* cursor = cursors.Get(seat.cursor_shape, scale);
+		if (cursor == nullptr)
+			return;
+
+		if (seat.cursor_surface == nullptr)
+			seat.cursor_surface = wl_compositor_create_surface(compositor);
+
+		seat.cursor       = cursor;
+		seat.cursor_image = 0;
+		seat.cursor_start = 0;
+
+		commit_cursor(index, true);
+	}
+
+	void Window::animate_cursor(int index, uint32_t time)
+	{
+		Seat& seat = seats[index];
+		if (seat.cursor == nullptr || seat.cursor_serial == 0 || seat.cursor->image_count < 2)
+			return;
+
+		if (seat.cursor_start == 0)
+			seat.cursor_start = time;
+
+		// Only a change of image attaches anything, the other refreshes just ask for the next one
+		int  image  = wl_cursor_frame(seat.cursor, time - seat.cursor_start);
+		bool attach = image != seat.cursor_image;
+
+		seat.cursor_image = image;
+		commit_cursor(index, attach);
+	}
+
+	void Window::commit_cursor(int index, bool attach)
+	{
+		Seat& seat = seats[index];
+
+		if (attach)
+		{
+			wl_cursor_image* image = seat.cursor->images[seat.cursor_image];
+
+			wl_surface_attach(seat.cursor_surface, wl_cursor_image_get_buffer(image), 0, 0);
+			if (wl_surface_get_version(seat.cursor_surface) >= WL_SURFACE_SET_BUFFER_SCALE_SINCE_VERSION)
+				wl_surface_set_buffer_scale(seat.cursor_surface, scale);
+			wl_surface_damage(seat.cursor_surface, 0, 0, INT32_MAX, INT32_MAX);
+
+			// Frames of one cursor can have different hotspots
+			wl_pointer_set_cursor(seat.pointer, seat.cursor_serial, seat.cursor_surface, image->hotspot_x / scale, image->hotspot_y / scale);
+		}
+
+		if (seat.cursor->image_count > 1 && seat.cursor_frame == nullptr)
+		{
+			seat.cursor_frame = wl_surface_frame(seat.cursor_surface);
+			wl_callback_add_listener(seat.cursor_frame, &Listeners::wl_callback_cursor, Seats::Data(index));
+		}
+
+		wl_surface_commit(seat.cursor_surface);
+	}
+
+	void Window::repeat()
+	{
+		uint64_t count = 0;
+		while (read(repeat_fd, &count, sizeof(count)) < 0 && errno == EINTR);
+
+		// Expirations the app was too busy to see are made up for, each is a key typed
+		KeyEvent event = repeat_key;
+		event.type     = KeyEvent::Repeat;
+		event.received = monotonic_ns();
+
+		for (uint64_t a = 0; a < count && repeating; a++)
+			handle_key(event);
+	}
+
+	void Window::stop_repeat(int seat)
+	{
+		if (!repeating || repeat_key.seat != seat)
+			return;
+
+		itimerspec timer = {};
+		timerfd_settime(repeat_fd, 0, &timer, nullptr);
+
+		repeating = false;
+	}
+
+	bool Window::PopMotion(MotionSample& sample)
+	{
+		return motion_history.Pop(sample);
+	}
+
+	PointerData Window::GetPointer(int seat)
+	{
+		return seats[seat].pointer_data;
+	}
+
+	TouchFrame Window::GetTouch(int seat)
+	{
+		return seats[seat].touch_data;
+	}
+
+	void Window::SetCursor(int seat, Cursors::Shape shape)
+	{
+		if (seats[seat].cursor_shape == shape)
+			return;
+
+		seats[seat].cursor_shape = shape;
+		show_cursor(seat);
+	}
+
+	PresentStats Window::GetPresentStats()
+	{
+		return feedback.Stats();
+	}
+
+	uint32_t Window::GetLatency(double percentile)
+	{
+		return feedback.Latency(percentile);
+	}
+
+	Seats& Window::GetSeats()
+	{
+		return seats;
+	}
+
+	Outputs& Window::GetOutputs()
+	{
+		return outputs;
+	}
+
+	int Window::GetScale()
+	{
+		return scale;
+	}
+
+	int32_t Window::GetRefresh()
+	{
+		int index = sync_output();
+		return index < 0 ? 0 : outputs[index].current.refresh;
+	}
+
+	EventLoop& Window::GetEventLoop()
+	{
+		return event_loop;
+	}
+
+	bool Window::IsOpen()
+	{
+		return isOpen;
+	}
+
+	void Window::ChangeWindowText(std::string text)
+	{
+	}
+
+	void Window::SetSize(int width, int height)
+	{
+	}
+	
 	void Window::SetPosition(int x, int y)
 	{
 	}
@@ -597,6 +1862,21 @@ namespace Wayland
 
 	}
 
+	void Window::SetInputThread(bool enabled)
+	{
+		input_threaded = enabled;
+	}
+
+	void Window::SetMotionHistory(bool enabled)
+	{
+		keep_motions = enabled;
+	}
+
+	void Window::SetScheduling(bool enabled)
+	{
+		scheduling = enabled;
+	}
+
 	void Window::Show(bool show)
 	{
 
@@ -612,31 +1892,11 @@ namespace Wayland
 		return false;
 	}
 
+	// Every resize and scale change ends up here. Buffers left at the old
+	// size are recreated as they are released, their pool space reused.
 	void Window::create_buffer() 
 	{
-        if (pool)
-        {
-            wl_shm_pool_destroy(pool);
-            close(fd);
-        }
-        
-		int stride = width * 4; // 4 bytes per pixel
-		int size = stride * height;
-
-		fd = os_create_anonymous_file(size);
-		if (fd < 0) {
-			fprintf(stderr, "creating a buffer file for %d B failed: %m\n", size);
-			exit(1);
-		}
-	
-		shm_data = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-		if (shm_data == MAP_FAILED) {
-			fprintf(stderr, "mmap failed: %m\n");
-			close(fd);
-			exit(1);
-		}
-
-		pool = wl_shm_create_pool(shm, fd, size);
-		shm_buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+		// In buffer pixels, scale of them to each of the surface's
+		swapchain.Resize(width * scale, height * scale);
 	}
 }
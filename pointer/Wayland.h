@@ -5,9 +5,19 @@
 #include <wayland-client-protocol.h>
 #include <xdg-shell-client-protocol.h>
 #include <xdg-decoration-client-protocol.h>
+#include <cursor-shape-v1-client-protocol.h>
+#include <presentation-time-client-protocol.h>
 
+#include "EventLoop.h"
+#include "Input.h"
+#include "Outputs.h"
+#include "Presentation.h"
+#include "Scheduler.h"
+#include "Seats.h"
+#include "Swapchain.h"
+
+#include <atomic>
 #include <string>
-#include <unordered_map>
 
 namespace Wayland
 {
@@ -25,6 +35,20 @@ namespace Wayland
 			void Name(void*, wl_seat*, const char*);
 		}
 
+		namespace WL_Output
+		{
+			void Geometry(void*, wl_output*, int32_t, int32_t, int32_t, int32_t, int32_t, const char*, const char*, int32_t);
+			void Mode(void*, wl_output*, uint32_t, int32_t, int32_t, int32_t);
+			void Done(void*, wl_output*);
+			void Scale(void*, wl_output*, int32_t);
+		}
+
+		namespace WL_Surface
+		{
+			void Enter(void*, wl_surface*, wl_output*);
+			void Leave(void*, wl_surface*, wl_output*);
+		}
+
 		namespace WL_Shell_Surface
 		{
 			void Ping(void*, wl_shell_surface*, uint32_t);
@@ -47,11 +71,22 @@ namespace Wayland
 			void Close(void*, xdg_toplevel*);
 		}
 
+		namespace WL_Callback
+		{
+			void Frame_Done(void*, wl_callback*, uint32_t);
+			void Cursor_Done(void*, wl_callback*, uint32_t);
+		}
+
 		namespace ZXDG_Toplevel_Decoration_V1
 		{
 			void Configure(void*, zxdg_toplevel_decoration_v1*, uint32_t);
 		}
 
+		namespace WP_Presentation
+		{
+			void Clock_Id(void*, wp_presentation*, uint32_t);
+		}
+
 		namespace WL_Pointer
 		{
 			void Enter(void*, struct wl_pointer*, uint32_t, struct wl_surface*, wl_fixed_t, wl_fixed_t);
@@ -64,46 +99,72 @@ namespace Wayland
 			void Axis_Stop(void*, struct wl_pointer*, uint32_t, uint32_t);
 			void Axis_Discrete(void*, struct wl_pointer*, uint32_t, int32_t);
 		}
+
+		namespace WL_Touch
+		{
+			void Down(void*, struct wl_touch*, uint32_t, uint32_t, struct wl_surface*, int32_t, wl_fixed_t, wl_fixed_t);
+			void Up(void*, struct wl_touch*, uint32_t, uint32_t, int32_t);
+			void Motion(void*, struct wl_touch*, uint32_t, int32_t, wl_fixed_t, wl_fixed_t);
+			void Frame(void*, struct wl_touch*);
+			void Cancel(void*, struct wl_touch*);
+		}
+
+		namespace WL_Keyboard
+		{
+			void Keymap(void*, struct wl_keyboard*, uint32_t, int32_t, uint32_t);
+			void Enter(void*, struct wl_keyboard*, uint32_t, struct wl_surface*, wl_array*);
+			void Leave(void*, struct wl_keyboard*, uint32_t, struct wl_surface*);
+			void Key(void*, struct wl_keyboard*, uint32_t, uint32_t, uint32_t, uint32_t);
+			void Modifiers(void*, struct wl_keyboard*, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+			void Repeat_Info(void*, struct wl_keyboard*, int32_t, int32_t);
+		}
 	}
 			
 	class Window
 	{
-		wl_surface                 * surface_wl         ;
-		wl_shell_surface           * shell_surface      ;
-		xdg_surface                * surface_xdg        ;
-		xdg_toplevel               * toplevel           ;
-		zxdg_toplevel_decoration_v1* toplevel_decoration;
-		wl_buffer                  * shm_buffer         ;
-		wl_shm_pool                * pool               ;
-
-		wl_pointer                 * pointer            ;
-		wl_keyboard                * keyboard           ;
-		wl_callback                * frame_cb           ;
-		wl_cursor_image            * cursor_image       ;
-		wl_buffer                  * cursor_buffer      ;
-		wl_surface                 * cursor_surface     ;
-
-		struct PointerData
-		{
-			double xPos, yPos;
-			bool left, middle, right;
-		};
+		wl_surface                 * surface_wl          = nullptr;
+		wl_shell_surface           * shell_surface       = nullptr;
+		xdg_surface                * surface_xdg         = nullptr;
+		xdg_toplevel               * toplevel            = nullptr;
+		zxdg_toplevel_decoration_v1* toplevel_decoration = nullptr;
 
-		std::unordered_map<wl_pointer*,PointerData> pointerData;
+		wl_callback                * frame_cb            = nullptr;
+
+		Swapchain swapchain; // frames are only drawn into buffers the compositor has released
+
+		Presentation feedback          ; // asked for on every commit
+		Scheduler    scheduler         ;
+		bool         scheduling = true ; // start frames as late as the refresh allows
+		uint64_t     frame_due  = 0    ; // when the next frame starts, on the presentation clock, 0 until it is decided
+		int          frame_fd   = -1   ; // a timerfd, armed while a frame waits for frame_due
+
+		InputThread              input          ;
+		bool                     input_threaded = false; // pointer events are read on input's thread
+		Ring<MotionSample, 1024> motion_history ; // every seat's, the newest are dropped while it is full
+		std::atomic<bool>        keep_motions   = false;
+		int                      repeat_fd      = -1   ; // a timerfd, armed while a key is held
+		KeyEvent                 repeat_key     ; // the held key
+		bool                     repeating      = false;
 
 		bool  isOpen  = false;
         bool  resized = true ;
+		bool  redraw  = true ;
 		int   x              ;
 		int   y              ;
 		int   width          ;
 		int   height         ;
-		char* shm_data       ;  
-		int   fd             ;
+		int   scale   = 1    ; // the largest of the outputs', buffers are drawn and cursors loaded for it
+
+		uint32_t entered = 0; // an Outputs::Bit for each output the surface is on
 
 	public:
 		friend void Functions::WL_Registry::Global(void*, wl_registry*, uint32_t, const char*, uint32_t);
+		friend void Functions::WL_Registry::Global_Remove(void*, wl_registry*, uint32_t);
 		friend void Functions::WL_Seat::Capabilities(void*, wl_seat*, uint32_t);
 		friend void Functions::WL_Seat::Name(void*, wl_seat*, const char*);
+		friend void Functions::WL_Output::Done(void*, wl_output*);
+		friend void Functions::WL_Surface::Enter(void*, wl_surface*, wl_output*);
+		friend void Functions::WL_Surface::Leave(void*, wl_surface*, wl_output*);
 		friend void Functions::WL_Shell_Surface::Ping(void*, wl_shell_surface*, uint32_t);
 		friend void Functions::WL_Shell_Surface::Configure(void*, wl_shell_surface*, uint32_t, int32_t, int32_t);
 		friend void Functions::XDG_WM_Base::Ping(void*, xdg_wm_base*, uint32_t);
@@ -111,6 +172,8 @@ namespace Wayland
 		friend void Functions::XDG_Toplevel::Configure(void*, xdg_toplevel*, int32_t, int32_t, wl_array*);
 		friend void Functions::XDG_Toplevel::Close(void*, xdg_toplevel*);
 		friend void Functions::ZXDG_Toplevel_Decoration_V1::Configure(void*, zxdg_toplevel_decoration_v1*, uint32_t);
+		friend void Functions::WL_Callback::Frame_Done(void*, wl_callback*, uint32_t);
+		friend void Functions::WL_Callback::Cursor_Done(void*, wl_callback*, uint32_t);
 		friend void Functions::WL_Pointer::Enter(void*, struct wl_pointer*, uint32_t, struct wl_surface*, wl_fixed_t, wl_fixed_t);
 		friend void Functions::WL_Pointer::Leave(void*, struct wl_pointer*, uint32_t, struct wl_surface*);
 		friend void Functions::WL_Pointer::Motion(void*, struct wl_pointer*, uint32_t, wl_fixed_t, wl_fixed_t);
@@ -120,10 +183,22 @@ namespace Wayland
 		friend void Functions::WL_Pointer::Axis_Source(void*, struct wl_pointer*, uint32_t);
 		friend void Functions::WL_Pointer::Axis_Stop(void*, struct wl_pointer*, uint32_t, uint32_t);
 		friend void Functions::WL_Pointer::Axis_Discrete(void*, struct wl_pointer*, uint32_t, int32_t);
+		friend void Functions::WL_Touch::Down(void*, struct wl_touch*, uint32_t, uint32_t, struct wl_surface*, int32_t, wl_fixed_t, wl_fixed_t);
+		friend void Functions::WL_Touch::Up(void*, struct wl_touch*, uint32_t, uint32_t, int32_t);
+		friend void Functions::WL_Touch::Motion(void*, struct wl_touch*, uint32_t, int32_t, wl_fixed_t, wl_fixed_t);
+		friend void Functions::WL_Touch::Frame(void*, struct wl_touch*);
+		friend void Functions::WL_Touch::Cancel(void*, struct wl_touch*);
+		friend void Functions::WL_Keyboard::Enter(void*, struct wl_keyboard*, uint32_t, struct wl_surface*, wl_array*);
+		friend void Functions::WL_Keyboard::Leave(void*, struct wl_keyboard*, uint32_t, struct wl_surface*);
+		friend void Functions::WL_Keyboard::Key(void*, struct wl_keyboard*, uint32_t, uint32_t, uint32_t, uint32_t);
+		friend void Functions::WL_Keyboard::Modifiers(void*, struct wl_keyboard*, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+		friend void Functions::WL_Keyboard::Repeat_Info(void*, struct wl_keyboard*, int32_t, int32_t);
 
 		void Init(int width, int height, int x, int y, bool show = true, Window* parent = nullptr, bool noDecoration = false, bool noTaskbarIcon = false, bool topmost = false);
+		void Destroy(); // before exit, while the statics it uses are still there
 
-		void  Poll				(						);
+		void  Poll				(int timeout = -1		); // milliseconds, -1 waits until something happens
+		void  Redraw			(						); // draw again when the compositor next asks for a frame
 		void* GetWindowHandler	(						);
 		void  ChangeWindowText	(std::string text		);
 		bool  IsOpen			(						);
@@ -131,11 +206,51 @@ namespace Wayland
 		void  SetPosition		(int x, int y			);
 		void  SetFocus			(						);
 		void  SetAlpha			(float alpha			);
+		void  SetInputThread	(bool enabled			); // before Init, read pointer events on their own thread
+		void  SetMotionHistory	(bool enabled			); // keep every motion, not only the latest of each frame
+		void  SetScheduling		(bool enabled			); // start each frame as late as the refresh allows, on by default
+		bool  PopMotion			(MotionSample& sample	); // oldest first, false once there are none left
+		PointerData GetPointer	(int seat				); // an index in GetSeats
+		TouchFrame  GetTouch	(int seat				); // the contacts as of the last frame handled
+		void  SetCursor			(int seat, Cursors::Shape shape); // shown whenever that seat's pointer is over the window
+		PresentStats GetPresentStats(					); // commit to screen, over the last Presentation::Capacity frames
+		uint32_t    GetLatency		(double percentile	); // ns from commit to screen, 0 until a frame is presented
+		int         GetScale		(					); // of the buffers drawn
+		int32_t     GetRefresh		(					); // mHz of the output frames are paced to, 0 until the surface is on one
+		static Outputs& GetOutputs	(					);
+		static Seats& GetSeats	(						);
 		void  Show				(bool show				);
 		bool  IsFocus			(						);
 		bool  IsMinimized		(						);
 		
-		static void SetupStatics();
+		static void       SetupStatics();
+		static void       DestroyStatics(); // once every window is destroyed
+		static EventLoop& GetEventLoop(); // add sockets and timers here to wait on them alongside the display
 		void create_buffer();
+
+	private:
+		// From the listeners, on whichever thread reads input
+		PointerFrame&        pointer_begin (int seat                  );
+		void                 pointer_end   (int seat                  ); // flushes each event when there are no frame events
+		void                 flush_pointer (int seat                  );
+		void                 key_event     (const KeyEvent& event     );
+		TouchFrame::Contact* touch_contact (int seat, int32_t id, bool down); // nullptr when it is not tracked and cannot be
+		void                 flush_touch   (int seat                  );
+
+		// On the app thread
+		void                 attach_seat   (int seat                  ); // creates and destroys devices to match its capabilities
+		void                 detach_seat   (int seat                  ); // destroys all of them
+		void                 handle_pointer(const PointerFrame& frame );
+		void                 handle_key    (const KeyEvent& event     );
+		void                 handle_touch  (const TouchFrame& frame   );
+		void                 show_cursor   (int seat                  ); // from the start, when the pointer enters or the shape changes
+		void                 animate_cursor(int seat, uint32_t time   ); // the cursor surface's frame callback
+		void                 commit_cursor (int seat, bool attach     );
+		void                 repeat        (                          ); // the repeat timer fired
+		void                 stop_repeat   (int seat                  ); // if that seat's key is repeating
+		void                 drain_input   (                          );
+		bool                 frame_ready   (uint64_t& start           ); // false while the next frame waits for frame_fd
+		void                 update_outputs(                          ); // the surface entered or left one, or one changed
+		int                  sync_output   (                          ); // the Outputs index frames are paced to, -1 when there is none
 	};
 }
@@ -1,4 +1,5 @@
 #include "Wayland.h"
+#include "Log.h"
 
 Wayland::Window window;
 
@@ -6,10 +7,40 @@ int main()
 {
 	Wayland::Window::SetupStatics();
 
+	window.SetInputThread(true);
 	window.Init(320, 200, 0, 0);
 
+	Wayland::PointerData drawn[Wayland::Seats::Capacity] = {}; // where each pointer was as of the last redraw
+
 	while(window.IsOpen())
 	{
 		window.Poll();
+
+		// A hand over the right of the window and a busy cursor along the
+		// bottom, anything else is the default
+		Wayland::Seats& seats = Wayland::Window::GetSeats();
+		for (int seat = 0; seat < seats.Used(); seat++)
+		{
+			Wayland::PointerData pointer = window.GetPointer(seat);
+			window.SetCursor(seat, pointer.xPos >= 120 ? Wayland::Cursors::Pointer :
+			                       pointer.yPos >= 130 ? Wayland::Cursors::Wait    : Wayland::Cursors::Default);
+
+			// Drawn again on every move, like an app showing what is under the pointer would
+			if (pointer.xPos != drawn[seat].xPos || pointer.yPos != drawn[seat].yPos)
+			{
+				window.Redraw();
+				drawn[seat] = pointer;
+			}
+		}
 	}
+
+	// Commit to screen, over the last frames shown
+	Wayland::PresentStats stats = window.GetPresentStats();
+	if (stats.frames > 0)
+		LOG(Info, "Latency: {:.2f}ms p50, {:.2f}ms p90, {:.2f}ms p99 over {} frames, {} refreshes missed, {} frames discarded", stats.latency_p50 / 1e6, stats.latency_p90 / 1e6, stats.latency_p99 / 1e6, stats.frames, stats.missed, stats.discarded);
+
+	LOG(Info, "Paced to {:.3f} Hz, drawn at scale {}", window.GetRefresh() / 1000.0, window.GetScale());
+
+	window.Destroy();
+	Wayland::Window::DestroyStatics();
 }
\ No newline at end of file
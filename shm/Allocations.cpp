@@ -0,0 +1,68 @@
+#include "Allocations.h"
+
+#include <cstdlib>
+
+#include <atomic>
+#include <new>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+namespace Wayland
+{
+	namespace Allocations
+	{
+		static thread_local uint64_t count    = 0;
+		static std::atomic<bool>     checking = true;
+
+		uint64_t Count()
+		{
+			return count;
+		}
+
+		void Check(bool enabled)
+		{
+			checking = enabled;
+		}
+
+		void Expect([[maybe_unused]] uint64_t before, [[maybe_unused]] const char* what)
+		{
+#ifdef WAYLAND_COUNT_ALLOCATIONS
+			if (checking && count != before)
+				throw std::runtime_error(fmt::format("{} allocated {} times", what, count - before));
+#endif
+		}
+
+	}
+}
+
+#ifdef WAYLAND_COUNT_ALLOCATIONS
+namespace Wayland
+{
+	namespace Allocations
+	{
+		// Shared by every replaced operator new below
+		static void* allocate(size_t size, size_t alignment = 0)
+		{
+			count++;
+
+			if (size == 0)
+				size = 1;
+
+			void* memory = alignment ? aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment) : malloc(size);
+			if (memory == nullptr)
+				throw std::bad_alloc();
+
+			return memory;
+		}
+	}
+}
+
+// The default operator deletes free(), which matches malloc and aligned_alloc
+void* operator new  (size_t size                                ) { return Wayland::Allocations::allocate(size); }
+void* operator new[](size_t size                                ) { return Wayland::Allocations::allocate(size); }
+void* operator new  (size_t size, std::align_val_t alignment    ) { return Wayland::Allocations::allocate(size, (size_t)alignment); }
+void* operator new[](size_t size, std::align_val_t alignment    ) { return Wayland::Allocations::allocate(size, (size_t)alignment); }
+void* operator new  (size_t size, const std::nothrow_t&) noexcept { try { return Wayland::Allocations::allocate(size); } catch (...) { return nullptr; } }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { try { return Wayland::Allocations::allocate(size); } catch (...) { return nullptr; } }
+#endif
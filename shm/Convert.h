@@ -0,0 +1,24 @@
+#pragma once
+
+#include <wayland-client-protocol.h>
+
+#include <cstdint>
+
+namespace Wayland
+{
+	// Converters from the 32-bit ARGB8888 canvas the fill kernels draw into
+	// to the narrower or wider wl_shm formats a window may pick. They follow
+	// whichever Fill::Path is selected.
+	namespace Convert
+	{
+		int  BytesPerPixel(uint32_t format); // of a wl_shm format
+		bool Needed       (uint32_t format); // false when the canvas can be used as is
+		bool HasAlpha     (uint32_t format);
+
+		void ToRGB565     (const uint32_t* source, uint16_t* destination, int count);
+		void ToXRGB2101010(const uint32_t* source, uint32_t* destination, int count);
+
+		// Converts rows [first, last) of a canvas into a buffer of the given format
+		void Rows(const uint32_t* source, int source_stride, char* destination, int destination_stride, int width, int first, int last, uint32_t format);
+	}
+}
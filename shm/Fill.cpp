@@ -0,0 +1,380 @@
+#include "Fill.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define FILL_X86
+#include <immintrin.h>
+#endif
+
+namespace Wayland
+{
+	namespace Fill
+	{
+		// Per channel 16.16 fixed point start and step, in pixel byte order (B, G, R, A)
+		struct Gradient
+		{
+			int32_t start[4];
+			int32_t step [4];
+		};
+
+		static Gradient setup_gradient(uint32_t from, uint32_t to, int length)
+		{
+			Gradient gradient;
+
+			for (int c = 0; c < 4; c++)
+			{
+				int32_t c0 = (from >> (c * 8)) & 0xFF;
+				int32_t c1 = (to   >> (c * 8)) & 0xFF;
+
+				gradient.start[c] = (c0 << 16) + 0x8000;
+				gradient.step [c] = length > 1 ? ((c1 - c0) * 65536) / (length - 1) : 0;
+			}
+
+			return gradient;
+		}
+
+		static uint32_t gradient_at(const Gradient& gradient, int i)
+		{
+			uint32_t pixel = 0;
+			for (int c = 0; c < 4; c++)
+				pixel |= (uint32_t)((gradient.start[c] + i * gradient.step[c]) >> 16) << (c * 8);
+			return pixel;
+		}
+
+		static uint32_t* row(uint32_t* data, int stride, int y)
+		{
+			return (uint32_t*)((char*)data + (intptr_t)y * stride);
+		}
+
+		struct Kernels
+		{
+			void (*solid_row   )(uint32_t* row, int width, uint32_t color            );
+			void (*gradient_row)(uint32_t* row, int width, const Gradient& gradient  );
+			bool (*opaque_row  )(const uint32_t* row, int width                      );
+		};
+
+		namespace Scalar
+		{
+			static void solid_row(uint32_t* row, int width, uint32_t color)
+			{
+				for (int x = 0; x < width; x++)
+					row[x] = color;
+			}
+
+			static void gradient_row(uint32_t* row, int width, const Gradient& gradient)
+			{
+				int32_t b = gradient.start[0], g = gradient.start[1], r = gradient.start[2], a = gradient.start[3];
+
+				for (int x = 0; x < width; x++)
+				{
+					row[x] = (uint32_t)(b >> 16) | (uint32_t)(g >> 16) << 8 | (uint32_t)(r >> 16) << 16 | (uint32_t)(a >> 16) << 24;
+
+					b += gradient.step[0];
+					g += gradient.step[1];
+					r += gradient.step[2];
+					a += gradient.step[3];
+				}
+			}
+
+			static bool opaque_row(const uint32_t* row, int width)
+			{
+				uint32_t all = 0xFFFFFFFF;
+				for (int x = 0; x < width; x++)
+					all &= row[x];
+
+				return (all >> 24) == 0xFF;
+			}
+		}
+
+#ifdef FILL_X86
+		namespace SSE2
+		{
+			__attribute__((target("sse2")))
+			static void solid_row(uint32_t* row, int width, uint32_t color)
+			{
+				__m128i value = _mm_set1_epi32(color);
+
+				int x = 0;
+				for (; x + 4 <= width; x += 4)
+					_mm_storeu_si128((__m128i*)(row + x), value);
+				for (; x < width; x++)
+					row[x] = color;
+			}
+
+			__attribute__((target("sse2")))
+			static __m128i pack(__m128i b, __m128i g, __m128i r, __m128i a)
+			{
+				// Every channel is within [0, 255 << 16], so masking replaces the shifts back
+				b = _mm_srli_epi32(b, 16);
+				g = _mm_and_si128(_mm_srli_epi32(g, 8), _mm_set1_epi32(0x0000FF00));
+				r = _mm_and_si128(r                   , _mm_set1_epi32(0x00FF0000));
+				a = _mm_and_si128(_mm_slli_epi32(a, 8), _mm_set1_epi32(0xFF000000));
+
+				return _mm_or_si128(_mm_or_si128(b, g), _mm_or_si128(r, a));
+			}
+
+			__attribute__((target("sse2")))
+			static void gradient_row(uint32_t* row, int width, const Gradient& gradient)
+			{
+				// Named registers rather than arrays, so nothing round trips through the stack
+				const int32_t* s = gradient.start;
+				const int32_t* d = gradient.step ;
+
+				__m128i b = _mm_setr_epi32(s[0], s[0] + d[0], s[0] + 2 * d[0], s[0] + 3 * d[0]);
+				__m128i g = _mm_setr_epi32(s[1], s[1] + d[1], s[1] + 2 * d[1], s[1] + 3 * d[1]);
+				__m128i r = _mm_setr_epi32(s[2], s[2] + d[2], s[2] + 2 * d[2], s[2] + 3 * d[2]);
+				__m128i a = _mm_setr_epi32(s[3], s[3] + d[3], s[3] + 2 * d[3], s[3] + 3 * d[3]);
+
+				const __m128i step_b = _mm_set1_epi32(4 * d[0]);
+				const __m128i step_g = _mm_set1_epi32(4 * d[1]);
+				const __m128i step_r = _mm_set1_epi32(4 * d[2]);
+				const __m128i step_a = _mm_set1_epi32(4 * d[3]);
+
+				int x = 0;
+				for (; x + 4 <= width; x += 4)
+				{
+					_mm_storeu_si128((__m128i*)(row + x), pack(b, g, r, a));
+
+					b = _mm_add_epi32(b, step_b);
+					g = _mm_add_epi32(g, step_g);
+					r = _mm_add_epi32(r, step_r);
+					a = _mm_add_epi32(a, step_a);
+				}
+				for (; x < width; x++)
+					row[x] = gradient_at(gradient, x);
+			}
+
+			__attribute__((target("sse2")))
+			static bool opaque_row(const uint32_t* row, int width)
+			{
+				__m128i all = _mm_set1_epi32(0xFFFFFFFF);
+
+				int x = 0;
+				for (; x + 4 <= width; x += 4)
+					all = _mm_and_si128(all, _mm_loadu_si128((const __m128i*)(row + x)));
+
+				// A lane compares to all ones when its alpha is 0xFF, movemask gathers one bit per lane
+				bool opaque = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_srli_epi32(all, 24), _mm_set1_epi32(0xFF)))) == 0xF;
+				for (; x < width; x++)
+					opaque &= (row[x] >> 24) == 0xFF;
+
+				return opaque;
+			}
+		}
+
+		namespace AVX2
+		{
+			__attribute__((target("avx2")))
+			static void solid_row(uint32_t* row, int width, uint32_t color)
+			{
+				__m256i value = _mm256_set1_epi32(color);
+
+				int x = 0;
+				for (; x + 8 <= width; x += 8)
+					_mm256_storeu_si256((__m256i*)(row + x), value);
+				for (; x < width; x++)
+					row[x] = color;
+			}
+
+			__attribute__((target("avx2")))
+			static __m256i lanes(int32_t start, int32_t step)
+			{
+				return _mm256_add_epi32(_mm256_set1_epi32(start), _mm256_mullo_epi32(_mm256_set1_epi32(step), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+			}
+
+			__attribute__((target("avx2")))
+			static void gradient_row(uint32_t* row, int width, const Gradient& gradient)
+			{
+				const int32_t* s = gradient.start;
+				const int32_t* d = gradient.step ;
+
+				__m256i b = lanes(s[0], d[0]);
+				__m256i g = lanes(s[1], d[1]);
+				__m256i r = lanes(s[2], d[2]);
+				__m256i a = lanes(s[3], d[3]);
+
+				const __m256i step_b = _mm256_set1_epi32(8 * d[0]);
+				const __m256i step_g = _mm256_set1_epi32(8 * d[1]);
+				const __m256i step_r = _mm256_set1_epi32(8 * d[2]);
+				const __m256i step_a = _mm256_set1_epi32(8 * d[3]);
+
+				const __m256i mask_g = _mm256_set1_epi32(0x0000FF00);
+				const __m256i mask_r = _mm256_set1_epi32(0x00FF0000);
+				const __m256i mask_a = _mm256_set1_epi32(0xFF000000);
+
+				int x = 0;
+				for (; x + 8 <= width; x += 8)
+				{
+					__m256i pixel = _mm256_or_si256(
+						_mm256_or_si256(_mm256_srli_epi32(b, 16), _mm256_and_si256(_mm256_srli_epi32(g, 8), mask_g)),
+						_mm256_or_si256(_mm256_and_si256(r, mask_r), _mm256_and_si256(_mm256_slli_epi32(a, 8), mask_a))
+					);
+					_mm256_storeu_si256((__m256i*)(row + x), pixel);
+
+					b = _mm256_add_epi32(b, step_b);
+					g = _mm256_add_epi32(g, step_g);
+					r = _mm256_add_epi32(r, step_r);
+					a = _mm256_add_epi32(a, step_a);
+				}
+				for (; x < width; x++)
+					row[x] = gradient_at(gradient, x);
+			}
+
+			__attribute__((target("avx2")))
+			static bool opaque_row(const uint32_t* row, int width)
+			{
+				__m256i all = _mm256_set1_epi32(0xFFFFFFFF);
+
+				int x = 0;
+				for (; x + 8 <= width; x += 8)
+					all = _mm256_and_si256(all, _mm256_loadu_si256((const __m256i*)(row + x)));
+
+				bool opaque = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_srli_epi32(all, 24), _mm256_set1_epi32(0xFF)))) == 0xFF;
+				for (; x < width; x++)
+					opaque &= (row[x] >> 24) == 0xFF;
+
+				return opaque;
+			}
+		}
+#endif
+
+		static const Kernels scalar_kernels = { Scalar::solid_row, Scalar::gradient_row, Scalar::opaque_row };
+#ifdef FILL_X86
+		static const Kernels sse2_kernels   = { SSE2  ::solid_row, SSE2  ::gradient_row, SSE2  ::opaque_row };
+		static const Kernels avx2_kernels   = { AVX2  ::solid_row, AVX2  ::gradient_row, AVX2  ::opaque_row };
+#endif
+
+		static Path best_path()
+		{
+			if (Supported(Path::AVX2)) return Path::AVX2;
+			if (Supported(Path::SSE2)) return Path::SSE2;
+			return Path::Scalar;
+		}
+
+		static Path           selected = Path::Scalar;
+		static const Kernels* kernels  = nullptr     ;
+
+		// The first fill may come from several workers at once, and a static
+		// local is initialized exactly once however many threads get there
+		static const Kernels& active()
+		{
+			static const bool chosen = kernels != nullptr || Select(best_path());
+			(void)chosen;
+
+			return *kernels;
+		}
+
+		bool Supported(Path path)
+		{
+#ifdef FILL_X86
+			__builtin_cpu_init();
+#endif
+
+			switch (path)
+			{
+			case Path::Scalar: return true;
+#ifdef FILL_X86
+			case Path::SSE2  : return __builtin_cpu_supports("sse2");
+			case Path::AVX2  : return __builtin_cpu_supports("avx2");
+#endif
+			default          : return false;
+			}
+		}
+
+		bool Select(Path path)
+		{
+			if (!Supported(path))
+				return false;
+
+			switch (path)
+			{
+#ifdef FILL_X86
+			case Path::SSE2: kernels = &sse2_kernels  ; break;
+			case Path::AVX2: kernels = &avx2_kernels  ; break;
+#endif
+			default        : kernels = &scalar_kernels; break;
+			}
+
+			selected = path;
+			return true;
+		}
+
+		Path Selected()
+		{
+			active();
+			return selected;
+		}
+
+		const char* Name(Path path)
+		{
+			switch (path)
+			{
+			case Path::SSE2: return "SSE2"  ;
+			case Path::AVX2: return "AVX2"  ;
+			default        : return "Scalar";
+			}
+		}
+
+		static int clamp_last(int height, int last)
+		{
+			return (last < 0 || last > height) ? height : last;
+		}
+
+		void Solid(uint32_t* data, int width, int height, int stride, uint32_t color, int first, int last)
+		{
+			const Kernels& k = active();
+			last = clamp_last(height, last);
+
+			for (int y = first; y < last; y++)
+				k.solid_row(row(data, stride, y), width, color);
+		}
+
+		void Horizontal(uint32_t* data, int width, int height, int stride, uint32_t left, uint32_t right, int first, int last)
+		{
+			last = clamp_last(height, last);
+			if (first >= last)
+				return;
+
+			uint32_t* source = row(data, stride, first);
+			active().gradient_row(source, width, setup_gradient(left, right, width));
+
+			// Every row is the same, so the rest are plain copies
+			for (int y = first + 1; y < last; y++)
+				memcpy(row(data, stride, y), source, width * sizeof(uint32_t));
+		}
+
+		void Vertical(uint32_t* data, int width, int height, int stride, uint32_t top, uint32_t bottom, int first, int last)
+		{
+			const Kernels& k = active();
+			Gradient gradient = setup_gradient(top, bottom, height);
+			last = clamp_last(height, last);
+
+			for (int y = first; y < last; y++)
+				k.solid_row(row(data, stride, y), width, gradient_at(gradient, y));
+		}
+
+		void Bilinear(uint32_t* data, int width, int height, int stride, uint32_t top_left, uint32_t top_right, uint32_t bottom_left, uint32_t bottom_right, int first, int last)
+		{
+			const Kernels& k = active();
+			Gradient left  = setup_gradient(top_left , bottom_left , height);
+			Gradient right = setup_gradient(top_right, bottom_right, height);
+			last = clamp_last(height, last);
+
+			for (int y = first; y < last; y++)
+				k.gradient_row(row(data, stride, y), width, setup_gradient(gradient_at(left, y), gradient_at(right, y), width));
+		}
+
+		bool Opaque(const uint32_t* data, int width, int height, int stride, int first, int last)
+		{
+			const Kernels& k = active();
+			last = clamp_last(height, last);
+
+			for (int y = first; y < last; y++)
+				if (!k.opaque_row(row((uint32_t*)data, stride, y), width))
+					return false;
+
+			return true;
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+namespace Wayland
+{
+	// Row-major fill kernels for 32-bit pixels (ARGB8888/XRGB8888 in native
+	// byte order, so 0xAARRGGBB). Every kernel writes whole rows with 32-bit
+	// or wider stores; stride is in bytes. Gradient endpoints are inclusive
+	// and interpolated per channel in 16.16 fixed point, so every path gives
+	// bit-identical results.
+	//
+	// data always points at row 0 of the whole fill. Passing first and last
+	// restricts the writes to rows [first, last), so a frame can be split into
+	// bands that are filled independently; last = -1 means height.
+	namespace Fill
+	{
+		enum class Path
+		{
+			Scalar,
+			SSE2  ,
+			AVX2  ,
+		};
+
+		bool        Supported(Path path);
+		bool        Select   (Path path); // defaults to the fastest supported path, call it before filling from several threads
+		Path        Selected (         );
+		const char* Name     (Path path);
+
+		void Solid     (uint32_t* data, int width, int height, int stride, uint32_t color                                                                          , int first = 0, int last = -1);
+		void Horizontal(uint32_t* data, int width, int height, int stride, uint32_t left    , uint32_t right                                                       , int first = 0, int last = -1);
+		void Vertical  (uint32_t* data, int width, int height, int stride, uint32_t top     , uint32_t bottom                                                      , int first = 0, int last = -1);
+		void Bilinear  (uint32_t* data, int width, int height, int stride, uint32_t top_left, uint32_t top_right, uint32_t bottom_left, uint32_t bottom_right, int first = 0, int last = -1);
+
+		// True when every pixel in the rows has an alpha of 0xFF
+		bool Opaque    (const uint32_t* data, int width, int height, int stride, int first = 0, int last = -1);
+	}
+}
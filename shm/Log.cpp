@@ -0,0 +1,188 @@
+#include "Log.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+namespace Wayland
+{
+	namespace Log
+	{
+		// A bounded ring any thread can log into without locking: a producer
+		// claims the slot at head with a compare-and-swap, formats into it and
+		// bumps its sequence to publish it. One writer thread drains the ring
+		// in order and turns whatever has piled up into a single write, so a
+		// burst of messages costs one syscall instead of one each. Producers
+		// only touch the mutex to wake the writer when it has gone to sleep.
+		class Writer
+		{
+			Slot                slots[Capacity];
+			std::atomic<size_t> head    = 0    ; // next slot to claim
+			size_t              tail    = 0    ; // next slot to write, writer thread only
+			std::atomic<size_t> written = 0    ; // copy of tail for Flush
+			std::atomic<size_t> dropped = 0    ;
+
+			std::thread             thread  ;
+			std::mutex              mutex   ;
+			std::condition_variable wake    ;
+			std::condition_variable drained ;
+			std::atomic<bool>       sleeping = false;
+			bool                    quit     = false;
+
+			bool Ready()
+			{
+				return slots[tail % Capacity].sequence.load() == tail + 1;
+			}
+
+			void Output(int fd, std::string& buffer)
+			{
+				size_t done = 0;
+				while (done < buffer.size())
+				{
+					ssize_t result = write(fd, buffer.data() + done, buffer.size() - done);
+					if (result <= 0)
+						break;
+
+					done += result;
+				}
+
+				buffer.clear();
+			}
+
+			void Run()
+			{
+				std::string out;
+				std::string err;
+
+				for (;;)
+				{
+					while (Ready())
+					{
+						Slot& slot = slots[tail % Capacity];
+
+						std::string& buffer = slot.level >= Level::Warn ? err : out;
+						buffer.append(slot.text, slot.size);
+						buffer.push_back('\n');
+
+						slot.sequence.store(tail + Capacity, std::memory_order_release);
+						tail++;
+					}
+
+					if (size_t count = dropped.exchange(0))
+						err += fmt::format("log: {} messages dropped\n", count);
+
+					Output(STDOUT_FILENO, out);
+					Output(STDERR_FILENO, err);
+
+					std::unique_lock<std::mutex> lock(mutex);
+
+					written = tail;
+					drained.notify_all();
+
+					if (quit && !Ready())
+						return;
+
+					// Publish checks sleeping after its store and Ready checks the
+					// slot after ours, so one of the two always sees the other
+					sleeping = true;
+					wake.wait(lock, [&] { return quit || Ready(); });
+					sleeping = false;
+				}
+			}
+
+		public:
+			Writer()
+			{
+				for (size_t a = 0; a < Capacity; a++)
+					slots[a].sequence.store(a, std::memory_order_relaxed);
+
+				thread = std::thread(&Writer::Run, this);
+			}
+
+			~Writer()
+			{
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					quit = true;
+				}
+
+				wake.notify_one();
+				thread.join();
+			}
+
+			Slot* Claim()
+			{
+				size_t position = head.load(std::memory_order_relaxed);
+
+				for (;;)
+				{
+					Slot&     slot     = slots[position % Capacity];
+					size_t    sequence = slot.sequence.load(std::memory_order_acquire);
+					ptrdiff_t lap      = (ptrdiff_t)sequence - (ptrdiff_t)position;
+
+					if (lap == 0)
+					{
+						if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+							return &slot;
+					}
+					else if (lap < 0)
+					{
+						// The writer has not caught up a whole ring behind, drop
+						// rather than block whoever is logging
+						dropped++;
+						return nullptr;
+					}
+					else
+						position = head.load(std::memory_order_relaxed);
+				}
+			}
+
+			void Publish(Slot* slot)
+			{
+				slot->sequence.store(slot->sequence.load(std::memory_order_relaxed) + 1);
+
+				if (sleeping.load())
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					wake.notify_one();
+				}
+			}
+
+			void Flush()
+			{
+				size_t target = head.load();
+
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.notify_one();
+				drained.wait(lock, [&] { return written >= target; });
+			}
+		};
+
+		static Writer& writer()
+		{
+			static Writer writer;
+			return writer;
+		}
+
+		// Starts the thread before main, rather than inside whichever callback logs first
+		[[maybe_unused]] static Writer& started = writer();
+
+		Slot* Claim()
+		{
+			return writer().Claim();
+		}
+
+		void Publish(Slot* slot)
+		{
+			writer().Publish(slot);
+		}
+
+		void Flush()
+		{
+			writer().Flush();
+		}
+	}
+}
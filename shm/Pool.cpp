@@ -0,0 +1,153 @@
+#include "Pool.h"
+#include "SharedMemory.h"
+
+#include <cstring>
+#include <climits>
+
+#include <stdexcept>
+#include <algorithm>
+
+#include <fmt/format.h>
+
+#include <sys/mman.h>
+#include <errno.h>
+#include <unistd.h>
+
+namespace Wayland
+{
+	static const size_t PageSize    = 4096      ;
+	static const size_t InitialSize = 1024 * 1024;
+
+	static size_t align_page(size_t size)
+	{
+		return (size + PageSize - 1) & ~(PageSize - 1);
+	}
+
+	void Pool::Init(wl_shm* shm)
+	{
+		this->shm = shm;
+	}
+
+	void Pool::Grow(size_t needed)
+	{
+		// Only the free range touching the end of the pool can be extended
+		size_t tail = 0;
+		if (!free_ranges.empty() && free_ranges.back().offset + free_ranges.back().size == size)
+			tail = free_ranges.back().size;
+
+		size_t new_size = std::max({ size * 2, size + needed - tail, InitialSize });
+		new_size = align_page(new_size);
+
+		// wl_shm_pool sizes are int32_t on the wire
+		if (new_size > INT32_MAX)
+			throw std::runtime_error(fmt::format("shm pool of {} B is too large", new_size));
+
+		if (pool == nullptr)
+		{
+			fd = SharedMemory::Create(new_size, SharedMemory::SealShrink, &memfd);
+			if (fd < 0)
+				throw std::runtime_error(fmt::format("Creating a buffer file for {} B failed: {}", new_size, strerror(errno)));
+
+			data = (char*)mmap(NULL, new_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			if (data == MAP_FAILED)
+			{
+				data = nullptr;
+				close(fd);
+				fd = -1;
+				throw std::runtime_error(fmt::format("mmap failed: {}", strerror(errno)));
+			}
+
+			pool = wl_shm_create_pool(shm, fd, new_size);
+		}
+		else
+		{
+			if (!SharedMemory::Grow(fd, new_size, memfd))
+				throw std::runtime_error(fmt::format("Growing a buffer file to {} B failed: {}", new_size, strerror(errno)));
+
+			char* new_data = (char*)mremap(data, size, new_size, MREMAP_MAYMOVE);
+			if (new_data == MAP_FAILED)
+				throw std::runtime_error(fmt::format("mremap failed: {}", strerror(errno)));
+
+			data = new_data;
+			wl_shm_pool_resize(pool, new_size);
+		}
+
+		Free(size, new_size - size);
+		size = new_size;
+	}
+
+	size_t Pool::Allocate(size_t size)
+	{
+		size = align_page(size);
+
+		auto range = std::find_if(free_ranges.begin(), free_ranges.end(), [size](const Range& range) { return range.size >= size; });
+		if (range == free_ranges.end())
+		{
+			Grow(size);
+			range = std::find_if(free_ranges.begin(), free_ranges.end(), [size](const Range& range) { return range.size >= size; });
+		}
+
+		size_t offset = range->offset;
+
+		range->offset += size;
+		range->size   -= size;
+		if (range->size == 0)
+			free_ranges.erase(range);
+
+		return offset;
+	}
+
+	void Pool::Free(size_t offset, size_t size)
+	{
+		size = align_page(size);
+		if (size == 0)
+			return;
+
+		auto next = std::lower_bound(free_ranges.begin(), free_ranges.end(), offset, [](const Range& range, size_t offset) { return range.offset < offset; });
+		auto range = free_ranges.insert(next, Range{ offset, size });
+
+		if (range + 1 != free_ranges.end() && range->offset + range->size == (range + 1)->offset)
+		{
+			range->size += (range + 1)->size;
+			free_ranges.erase(range + 1);
+		}
+
+		if (range != free_ranges.begin() && (range - 1)->offset + (range - 1)->size == range->offset)
+		{
+			(range - 1)->size += range->size;
+			free_ranges.erase(range);
+		}
+	}
+
+	wl_buffer* Pool::CreateBuffer(size_t offset, int width, int height, int stride, uint32_t format)
+	{
+		return wl_shm_pool_create_buffer(pool, offset, width, height, stride, format);
+	}
+
+	char* Pool::Data(size_t offset)
+	{
+		return data + offset;
+	}
+
+	size_t Pool::Size()
+	{
+		return size;
+	}
+
+	void Pool::Destroy()
+	{
+		if (pool)
+		{
+			wl_shm_pool_destroy(pool);
+			munmap(data, size);
+			close(fd);
+		}
+
+		pool  = nullptr;
+		data  = nullptr;
+		size  = 0;
+		fd    = -1;
+		memfd = false;
+		free_ranges.clear();
+	}
+}
@@ -0,0 +1,181 @@
+#include "Region.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace Wayland
+{
+	bool Rect::Empty() const
+	{
+		return width <= 0 || height <= 0;
+	}
+
+	int Rect::Area() const
+	{
+		return Empty() ? 0 : width * height;
+	}
+
+	bool Rect::Contains(const Rect& other) const
+	{
+		return other.x >= x && other.y >= y && other.x + other.width <= x + width && other.y + other.height <= y + height;
+	}
+
+	Rect Rect::Union(const Rect& other) const
+	{
+		if (Empty()      ) return other;
+		if (other.Empty()) return *this;
+
+		int left   = std::min(x, other.x);
+		int top    = std::min(y, other.y);
+		int right  = std::max(x + width , other.x + other.width );
+		int bottom = std::max(y + height, other.y + other.height);
+
+		return Rect{ left, top, right - left, bottom - top };
+	}
+
+	Rect Rect::Intersect(const Rect& other) const
+	{
+		int left   = std::max(x, other.x);
+		int top    = std::max(y, other.y);
+		int right  = std::min(x + width , other.x + other.width );
+		int bottom = std::min(y + height, other.y + other.height);
+
+		if (right <= left || bottom <= top)
+			return Rect{};
+
+		return Rect{ left, top, right - left, bottom - top };
+	}
+
+	void Region::Remove(int index)
+	{
+		rects[index] = rects[--count];
+	}
+
+	void Region::Add(const Rect& rect)
+	{
+		if (rect.Empty())
+			return;
+
+		Rect added = rect;
+
+		for (int a = 0; a < count; a++)
+			if (rects[a].Contains(added))
+				return;
+
+		// Swallow anything the new rectangle covers, and merge with anything
+		// it overlaps when the bounding box costs no extra area
+		for (int a = 0; a < count;)
+		{
+			Rect merged = added.Union(rects[a]);
+
+			if (added.Contains(rects[a]) || merged.Area() <= added.Area() + rects[a].Area() - added.Intersect(rects[a]).Area())
+			{
+				added = merged;
+				Remove(a);
+				a = 0;
+			}
+			else
+				a++;
+		}
+
+		if (count < MaxRects)
+		{
+			rects[count++] = added;
+			return;
+		}
+
+		// Full, merge whichever pair (the new rectangle included) wastes the least area
+		int  best_a = 0, best_b = 0;
+		long best   = LONG_MAX;
+
+		for (int a = 0; a <= count; a++)
+		{
+			const Rect& first = a == count ? added : rects[a];
+
+			for (int b = a + 1; b <= count; b++)
+			{
+				const Rect& second = b == count ? added : rects[b];
+
+				long waste = (long)first.Union(second).Area() - first.Area() - second.Area();
+				if (waste < best)
+				{
+					best   = waste;
+					best_a = a;
+					best_b = b;
+				}
+			}
+		}
+
+		if (best_b == count)
+		{
+			Rect merged = rects[best_a].Union(added);
+			Remove(best_a);
+			Add(merged);
+		}
+		else
+		{
+			Rect merged = rects[best_a].Union(rects[best_b]);
+			Remove(best_b);
+			Remove(best_a);
+			Add(merged);
+			Add(added);
+		}
+	}
+
+	void Region::Add(const Region& region)
+	{
+		for (const Rect& rect : region)
+			Add(rect);
+	}
+
+	void Region::Clip(const Rect& bounds)
+	{
+		for (int a = 0; a < count;)
+		{
+			rects[a] = rects[a].Intersect(bounds);
+
+			if (rects[a].Empty())
+				Remove(a);
+			else
+				a++;
+		}
+	}
+
+	void Region::Clear()
+	{
+		count = 0;
+	}
+
+	bool Region::Empty() const
+	{
+		return count == 0;
+	}
+
+	int Region::Area() const
+	{
+		int area = 0;
+		for (const Rect& rect : *this)
+			area += rect.Area();
+		return area;
+	}
+
+	Rect Region::Bounds() const
+	{
+		Rect bounds;
+		for (const Rect& rect : *this)
+			bounds = bounds.Union(rect);
+		return bounds;
+	}
+
+	bool Region::operator==(const Region& other) const
+	{
+		if (count != other.count)
+			return false;
+
+		for (int a = 0; a < count; a++)
+			if (rects[a].x != other.rects[a].x || rects[a].y != other.rects[a].y || rects[a].width != other.rects[a].width || rects[a].height != other.rects[a].height)
+				return false;
+
+		return true;
+	}
+}
@@ -0,0 +1,108 @@
+#include "Swapchain.h"
+#include "Convert.h"
+
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+namespace Wayland
+{
+	namespace Functions
+	{
+		namespace WL_Buffer
+		{
+			void Release(void* data, wl_buffer* wl_buffer)
+			{
+				Buffer* buffer = (Buffer*)data;
+				buffer->busy = false;
+			}
+		}
+	}
+
+	namespace Listeners
+	{
+		wl_buffer_listener wl_buffer
+		{
+			.release = Functions::WL_Buffer::Release
+		};
+	}
+
+	void Swapchain::Init(wl_shm* shm, int count)
+	{
+		if (count < 2 || count > MaxBuffers)
+			throw std::runtime_error(fmt::format("Swapchain needs 2 to {} buffers, got {}", MaxBuffers, count));
+
+		this->count = count;
+		pool.Init(shm);
+	}
+
+	void Swapchain::DestroyBuffer(Buffer& buffer)
+	{
+		wl_buffer_destroy(buffer.buffer);
+		pool.Free(buffer.offset, buffer.size);
+
+		buffer = Buffer{};
+	}
+
+	void Swapchain::Resize(int width, int height)
+	{
+		this->width  = width ;
+		this->height = height;
+	}
+
+	void Swapchain::SetFormat(uint32_t format)
+	{
+		this->format = format;
+	}
+
+	Buffer* Swapchain::Acquire()
+	{
+		for (int a = 0; a < count; a++)
+		{
+			Buffer& buffer = buffers[a];
+
+			if (buffer.busy)
+				continue;
+
+			if (buffer.buffer && (buffer.width != width || buffer.height != height || buffer.format != format))
+				DestroyBuffer(buffer);
+
+			if (buffer.buffer == nullptr)
+			{
+				buffer.width  = width ;
+				buffer.height = height;
+				buffer.format = format;
+				buffer.stride = width * Convert::BytesPerPixel(format);
+				buffer.size   = (size_t)buffer.stride * height;
+				buffer.offset = pool.Allocate(buffer.size);
+				buffer.buffer = pool.CreateBuffer(buffer.offset, width, height, buffer.stride, format);
+
+				wl_buffer_add_listener(buffer.buffer, &Listeners::wl_buffer, &buffer);
+
+				buffer.damage.Add(Rect{ 0, 0, width, height });
+			}
+
+			// The pool may have moved while growing
+			buffer.data = pool.Data(buffer.offset);
+			return &buffer;
+		}
+
+		return nullptr;
+	}
+
+	void Swapchain::Damage(const Region& region)
+	{
+		for (int a = 0; a < count; a++)
+			if (buffers[a].buffer)
+				buffers[a].damage.Add(region);
+	}
+
+	void Swapchain::Destroy()
+	{
+		for (Buffer& buffer : buffers)
+			if (buffer.buffer)
+				DestroyBuffer(buffer);
+
+		pool.Destroy();
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <wayland-client.h>
+#include <wayland-client-protocol.h>
+
+#include "Pool.h"
+#include "Region.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Wayland
+{
+	namespace Functions
+	{
+		namespace WL_Buffer
+		{
+			void Release(void*, wl_buffer*);
+		}
+	}
+
+	struct Buffer
+	{
+		wl_buffer* buffer = nullptr;
+		char     * data   = nullptr; // only valid until the next Swapchain::Acquire
+		size_t     offset = 0      ;
+		size_t     size   = 0      ;
+		int        width  = 0      ;
+		int        height = 0      ;
+		int        stride = 0      ;
+		uint32_t   format = 0      ;
+		bool       busy   = false  ; // held by the compositor until wl_buffer.release
+		Region     damage          ; // what changed since this buffer was last drawn
+	};
+
+	// A small ring of wl_buffers backed by one growable shm pool. Buffers are
+	// only handed out once the compositor has released them, so the client
+	// can draw the next frame while the previous one is still being sampled.
+	// Buffers left at an old size by a resize are recreated when they are
+	// next acquired.
+	class Swapchain
+	{
+	public:
+		static constexpr int MaxBuffers = 3;
+
+	private:
+		Pool     pool                            ;
+		int      count  = 2                      ;
+		int      width  = 0                      ;
+		int      height = 0                      ;
+		uint32_t format = WL_SHM_FORMAT_ARGB8888 ;
+
+		Buffer buffers[MaxBuffers];
+
+		void DestroyBuffer(Buffer& buffer);
+
+	public:
+		void    Init     (wl_shm* shm, int count = 2);
+		void    Resize   (int width, int height     );
+		void    SetFormat(uint32_t format           ); // a wl_shm format, see Convert::BytesPerPixel
+		Buffer* Acquire  (                          );
+		void    Damage   (const Region& region      ); // marks region stale in every buffer
+		void    Destroy  (                          );
+	};
+}
@@ -1,11 +1,17 @@
 #include "Wayland.h"
+#include "Fill.h"
+#include "Convert.h"
+#include "Log.h"
 
 #include <cstring>
 #include <cstdint>
 
 #include <stdexcept>
-#include <iostream>
+#include <string_view>
 #include <vector>
+#include <algorithm>
+#include <iterator>
+#include <atomic>
 
 #include <fmt/format.h>
 
@@ -19,80 +25,6 @@
 	     (const char *) pos < ((const char *) (array)->data + (array)->size); \
 	     (pos)++)
 
-static int set_cloexec_or_close(int fd)
-{
-	long flags;
-
-	if (fd == -1)
-			return -1;
-
-	flags = fcntl(fd, F_GETFD);
-	if (flags == -1)
-		goto err;
-
-	if (fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1)
-		goto err;
-
-	return fd;
-
-err:
-	close(fd);
-	return -1;
-}
-
-static int create_tmpfile_cloexec(char *tmpname)
-{
-	int fd;
-
-#ifdef HAVE_MKOSTEMP
-	fd = mkostemp(tmpname, O_CLOEXEC);
-	if (fd >= 0)
-			unlink(tmpname);
-#else
-	fd = mkstemp(tmpname);
-	if (fd >= 0) {
-		fd = set_cloexec_or_close(fd);
-		unlink(tmpname);
-	}
-#endif
-
-	return fd;
-}
-
-int os_create_anonymous_file(off_t size)
-{
-	static const char templatea[] = "/weston-shared-XXXXXX";
-	const char *path;
-	char *name;
-	int fd;
-
-	path = getenv("XDG_RUNTIME_DIR");
-	if (!path) {
-		errno = ENOENT;
-		return -1;
-	}
-
-	name = (char*)malloc(strlen(path) + sizeof(templatea));
-	if (!name)
-		return -1;
-	strcpy(name, path);
-	strcat(name, templatea);
-
-	fd = create_tmpfile_cloexec(name);
-
-	free(name);
-
-	if (fd < 0)
-		return -1;
-
-	if (ftruncate(fd, size) < 0) {
-		close(fd);
-		return -1;
-	}
-
-	return fd;
-}
-
 namespace Wayland
 {
 	wl_display*                 display;
@@ -103,28 +35,164 @@ namespace Wayland
 	wl_seat*                    seat;
 	wl_shm*                     shm;
 	zxdg_decoration_manager_v1* decoration_manager;
+	EventLoop                   event_loop;
+	std::vector<uint32_t>       shm_formats;
+
+	// Names for logging. Constant tables, so dispatching an event never
+	// allocates to describe it.
+	namespace Names
+	{
+		struct ShmFormatName
+		{
+			uint32_t         format;
+			std::string_view name  ;
+		};
+
+		#define Format(name) ShmFormatName{ WL_SHM_FORMAT_##name, "WL_SHM_FORMAT_" #name }
+
+		constexpr ShmFormatName shm_formats[] = {
+			Format(ARGB8888),
+			Format(XRGB8888),
+			Format(C8),
+			Format(RGB332),
+			Format(BGR233),
+			Format(XRGB4444),
+			Format(XBGR4444),
+			Format(RGBX4444),
+			Format(BGRX4444),
+			Format(ARGB4444),
+			Format(ABGR4444),
+			Format(RGBA4444),
+			Format(BGRA4444),
+			Format(XRGB1555),
+			Format(XBGR1555),
+			Format(RGBX5551),
+			Format(BGRX5551),
+			Format(ARGB1555),
+			Format(ABGR1555),
+			Format(RGBA5551),
+			Format(BGRA5551),
+			Format(RGB565),
+			Format(BGR565),
+			Format(RGB888),
+			Format(BGR888),
+			Format(XBGR8888),
+			Format(RGBX8888),
+			Format(BGRX8888),
+			Format(ABGR8888),
+			Format(RGBA8888),
+			Format(BGRA8888),
+			Format(XRGB2101010),
+			Format(XBGR2101010),
+			Format(RGBX1010102),
+			Format(BGRX1010102),
+			Format(ARGB2101010),
+			Format(ABGR2101010),
+			Format(RGBA1010102),
+			Format(BGRA1010102),
+			Format(YUYV),
+			Format(YVYU),
+			Format(UYVY),
+			Format(VYUY),
+			Format(AYUV),
+			Format(NV12),
+			Format(NV21),
+			Format(NV16),
+			Format(NV61),
+			Format(YUV410),
+			Format(YVU410),
+			Format(YUV411),
+			Format(YVU411),
+			Format(YUV420),
+			Format(YVU420),
+			Format(YUV422),
+			Format(YVU422),
+			Format(YUV444),
+			Format(YVU444),
+		};
+
+		#undef Format
+
+		constexpr std::string_view toplevel_states[] = {
+			"",
+			"XDG_TOPLEVEL_STATE_MAXIMIZED",
+			"XDG_TOPLEVEL_STATE_FULLSCREEN",
+			"XDG_TOPLEVEL_STATE_RESIZING",
+			"XDG_TOPLEVEL_STATE_ACTIVATED",
+			"XDG_TOPLEVEL_STATE_TILED_LEFT",
+			"XDG_TOPLEVEL_STATE_TILED_RIGHT",
+			"XDG_TOPLEVEL_STATE_TILED_TOP",
+			"XDG_TOPLEVEL_STATE_TILED_BOTTOM",
+		};
+
+		constexpr std::string_view decoration_modes[] = {
+			"",
+			"ZXDG_TOPLEVEL_DECORATION_V1_MODE_CLIENT_SIDE",
+			"ZXDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE",
+		};
+
+		// Empty for values the table does not know
+		template<size_t N>
+		constexpr std::string_view Get(const std::string_view (&names)[N], uint32_t value)
+		{
+			return value < N ? names[value] : std::string_view();
+		}
+
+		constexpr std::string_view ShmFormat(uint32_t format)
+		{
+			for (const ShmFormatName& entry : shm_formats)
+				if (entry.format == format)
+					return entry.name;
+
+			return std::string_view();
+		}
+	}
 
 	namespace Functions
 	{
 		namespace WL_Registry
 		{
-			#define Bind(T, var)\
-				if (!strcmp(interface, #T)) \
-					var = (T*)wl_registry_bind(wl_registry, name, &T##_interface, version)
+			// Every global the client binds, sorted by name for a binary search.
+			// version is the newest one our listeners implement. A compositor
+			// advertising a newer one is bound at ours, so it never sends
+			// events we have no handler for.
+			struct Interface
+			{
+				std::string_view    name   ;
+				const wl_interface* type   ;
+				uint32_t            version;
+				void              (*bind  )(wl_registry*, uint32_t name, const wl_interface* type, uint32_t version);
+			};
+
+			#define Bind(T, var, version) \
+				Interface{ #T, &T##_interface, version, [](wl_registry* wl_registry, uint32_t name, const wl_interface* type, uint32_t bound) \
+				{ \
+					var = (T*)wl_registry_bind(wl_registry, name, type, bound); \
+				} }
+
+			constexpr Interface interfaces[] = {
+				Bind(wl_compositor             , compositor        , 4), // damage_buffer
+				Bind(wl_seat                   , seat              , 2), // name
+				Bind(wl_shell                  , shell             , 1),
+				Bind(wl_shm                    , shm               , 1),
+				Bind(xdg_wm_base               , wm_base           , 2),
+				Bind(zxdg_decoration_manager_v1, decoration_manager, 1),
+			};
+
+			#undef Bind
+
+			static_assert(std::is_sorted(std::begin(interfaces), std::end(interfaces), [](const Interface& a, const Interface& b) { return a.name < b.name; }), "Registry interfaces must be sorted by name");
 
 			void Global(void* data, wl_registry* wl_registry, uint32_t name, const char* interface, uint32_t version)
 			{
-				std::cout << fmt::format("{}: {} {}\n", name, interface, version);
-
-				Bind(wl_compositor             , compositor        );
-				Bind(wl_shell                  , shell             );
-				Bind(wl_seat                   , seat              );
-				Bind(wl_shm                    , shm               );
-				Bind(xdg_wm_base               , wm_base           );
-				Bind(zxdg_decoration_manager_v1, decoration_manager);
-			}
+				LOG(Debug, "{}: {} {}", name, interface, version);
 
-			#undef Bind
+				std::string_view key   = interface;
+				const Interface* entry = std::lower_bound(std::begin(interfaces), std::end(interfaces), key, [](const Interface& entry, std::string_view key) { return entry.name < key; });
+
+				if (entry != std::end(interfaces) && entry->name == key)
+					entry->bind(wl_registry, name, entry->type, std::min(version, entry->version));
+			}
 
 			void Global_Remove(void* data, wl_registry* wl_registry, uint32_t name)
 			{
@@ -183,30 +251,15 @@ namespace Wayland
 			{
 				Window* window = (Window*)data;
 
-				std::vector<std::string> state_strings = {
-					"",
-					"XDG_TOPLEVEL_STATE_MAXIMIZED",
-					"XDG_TOPLEVEL_STATE_FULLSCREEN",
-					"XDG_TOPLEVEL_STATE_RESIZING",
-					"XDG_TOPLEVEL_STATE_ACTIVATED",
-					"XDG_TOPLEVEL_STATE_TILED_LEFT",
-					"XDG_TOPLEVEL_STATE_TILED_RIGHT",
-					"XDG_TOPLEVEL_STATE_TILED_TOP",
-					"XDG_TOPLEVEL_STATE_TILED_BOTTOM"
-				};
-                
                 bool resizing = false;
 				
-				std::cout << fmt::format("Size: {},{}\n", width, height);
-				std::cout << fmt::format("State Changes: {}, {}\n", states->size, states->alloc);
+				LOG(Debug, "Size: {},{}", width, height);
+				LOG(Debug, "State Changes: {}, {}", states->size, states->alloc);
 				
 				const uint32_t *state;
 				WL_ARRAY_FOR_EACH(state, states, const uint32_t*)
 				{
-					std::string state_string = "";
-					if (*state < state_strings.size())
-						state_string = state_strings[*state];
-					std::cout << fmt::format("\t{}: {}\n", *state, state_string);
+					LOG(Debug, "\t{}: {}", *state, Names::Get(Names::toplevel_states, *state));
                     
                     if (*state == 3)
                         resizing = true;
@@ -237,13 +290,22 @@ namespace Wayland
 			}
 		}
 
+		namespace WL_Callback
+		{
+			void Frame_Done(void* data, wl_callback* wl_callback, uint32_t time)
+			{
+				Window* window = (Window*)data;
+
+				wl_callback_destroy(wl_callback);
+				window->frame_cb = nullptr;
+			}
+		}
+
 		namespace ZXDG_Toplevel_Decoration_V1
 		{
 			void Configure(void* data, zxdg_toplevel_decoration_v1* zxdg_toplevel_decoration_v1, uint32_t mode)
 			{
-				std::vector<std::string> modes = {"","ZXDG_TOPLEVEL_DECORATION_V1_MODE_CLIENT_SIDE","ZXDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE"};
-				std::string mode_string = modes[mode];
-				std::cout << fmt::format("Mode: {}\n", mode_string);
+				LOG(Info, "Mode: {}", Names::Get(Names::decoration_modes, mode));
 			}
 		}
 
@@ -251,71 +313,14 @@ namespace Wayland
 		{
 			void Format(void* data, wl_shm* wl_shm, uint32_t format)
 			{
-				std::vector<std::string> formats = {
-					"WL_SHM_FORMAT_ARGB8888",
-					"WL_SHM_FORMAT_XRGB8888",
-					"WL_SHM_FORMAT_C8",
-					"WL_SHM_FORMAT_RGB332",
-					"WL_SHM_FORMAT_BGR233",
-					"WL_SHM_FORMAT_XRGB4444",
-					"WL_SHM_FORMAT_XBGR4444",
-					"WL_SHM_FORMAT_RGBX4444",
-					"WL_SHM_FORMAT_BGRX4444",
-					"WL_SHM_FORMAT_ARGB4444",
-					"WL_SHM_FORMAT_ABGR4444",
-					"WL_SHM_FORMAT_RGBA4444",
-					"WL_SHM_FORMAT_BGRA4444",
-					"WL_SHM_FORMAT_XRGB1555",
-					"WL_SHM_FORMAT_XBGR1555",
-					"WL_SHM_FORMAT_RGBX5551",
-					"WL_SHM_FORMAT_BGRX5551",
-					"WL_SHM_FORMAT_ARGB1555",
-					"WL_SHM_FORMAT_ABGR1555",
-					"WL_SHM_FORMAT_RGBA5551",
-					"WL_SHM_FORMAT_BGRA5551",
-					"WL_SHM_FORMAT_RGB565",
-					"WL_SHM_FORMAT_BGR565",
-					"WL_SHM_FORMAT_RGB888",
-					"WL_SHM_FORMAT_BGR888",
-					"WL_SHM_FORMAT_XBGR8888",
-					"WL_SHM_FORMAT_RGBX8888",
-					"WL_SHM_FORMAT_BGRX8888",
-					"WL_SHM_FORMAT_ABGR8888",
-					"WL_SHM_FORMAT_RGBA8888",
-					"WL_SHM_FORMAT_BGRA8888",
-					"WL_SHM_FORMAT_XRGB2101010",
-					"WL_SHM_FORMAT_XBGR2101010",
-					"WL_SHM_FORMAT_RGBX1010102",
-					"WL_SHM_FORMAT_BGRX1010102",
-					"WL_SHM_FORMAT_ARGB2101010",
-					"WL_SHM_FORMAT_ABGR2101010",
-					"WL_SHM_FORMAT_RGBA1010102",
-					"WL_SHM_FORMAT_BGRA1010102",
-					"WL_SHM_FORMAT_YUYV",
-					"WL_SHM_FORMAT_YVYU",
-					"WL_SHM_FORMAT_UYVY",
-					"WL_SHM_FORMAT_VYUY",
-					"WL_SHM_FORMAT_AYUV",
-					"WL_SHM_FORMAT_NV12",
-					"WL_SHM_FORMAT_NV21",
-					"WL_SHM_FORMAT_NV16",
-					"WL_SHM_FORMAT_NV61",
-					"WL_SHM_FORMAT_YUV410",
-					"WL_SHM_FORMAT_YVU410",
-					"WL_SHM_FORMAT_YUV411",
-					"WL_SHM_FORMAT_YVU411",
-					"WL_SHM_FORMAT_YUV420",
-					"WL_SHM_FORMAT_YVU420",
-					"WL_SHM_FORMAT_YUV422",
-					"WL_SHM_FORMAT_YVU422",
-					"WL_SHM_FORMAT_YUV444",
-					"WL_SHM_FORMAT_YVU444"
-				};
-
-				if (format < formats.size())
-					std::cout << fmt::format("Format Supported: {}\n", formats[format]);
+				if (std::find(shm_formats.begin(), shm_formats.end(), format) == shm_formats.end())
+					shm_formats.push_back(format);
+
+				std::string_view name = Names::ShmFormat(format);
+				if (!name.empty())
+					LOG(Debug, "Format Supported: {}", name);
 				else
-					std::cout << fmt::format("Unknown Format: {}\n", format);
+					LOG(Debug, "Unknown Format: {}", format);
 			}
 		}
 	}
@@ -356,6 +361,11 @@ namespace Wayland
 			.close = Functions::XDG_Toplevel::Close
 		};
 
+		wl_callback_listener wl_callback_frame
+		{
+			.done = Functions::WL_Callback::Frame_Done
+		};
+
 		zxdg_toplevel_decoration_v1_listener zxdg_toplevel_decoration_v1
 		{
 			.configure = Functions::ZXDG_Toplevel_Decoration_V1::Configure,
@@ -367,12 +377,34 @@ namespace Wayland
 		};
 	}
 
+	static bool shm_supports(uint32_t format)
+	{
+		// ARGB8888 and XRGB8888 are always supported, even if not advertised
+		if (format == WL_SHM_FORMAT_ARGB8888 || format == WL_SHM_FORMAT_XRGB8888)
+			return true;
+
+		return std::find(shm_formats.begin(), shm_formats.end(), format) != shm_formats.end();
+	}
+
+	static uint32_t choose_format(FormatHint hint)
+	{
+		switch (hint)
+		{
+		case FormatHint::Opaque       : return WL_SHM_FORMAT_XRGB8888;
+		case FormatHint::LowBandwidth : return shm_supports(WL_SHM_FORMAT_RGB565     ) ? WL_SHM_FORMAT_RGB565      : WL_SHM_FORMAT_XRGB8888;
+		case FormatHint::HighPrecision: return shm_supports(WL_SHM_FORMAT_XRGB2101010) ? WL_SHM_FORMAT_XRGB2101010 : WL_SHM_FORMAT_XRGB8888;
+		default                       : return WL_SHM_FORMAT_ARGB8888;
+		}
+	}
+
 	void Window::SetupStatics()
 	{
 		display = wl_display_connect(NULL);
 		if (display == nullptr)
 			throw std::runtime_error("No display found");
 
+		event_loop.Init(display);
+
 		registry = wl_display_get_registry(display);
 
 		wl_registry_add_listener(registry, &Listeners::wl_registry, nullptr);
@@ -422,6 +454,8 @@ namespace Wayland
 			zxdg_toplevel_decoration_v1_set_mode(toplevel_decoration, ZXDG_TOPLEVEL_DECORATION_V1_MODE_SERVER_SIDE);
 		}
 
+		swapchain.Init(shm);
+
 		this->x      = x     ;
 		this->y      = y     ;
 		this->width  = width ;
@@ -438,40 +472,134 @@ namespace Wayland
 		return surface_wl;
 	}
 
-	void Window::Poll()
+	void Window::Poll(int timeout)
 	{
-        wl_display_roundtrip(display);
-        
-        if (resized)
-        {
-            std::cout << fmt::format("Current Size: {},{}\n", width, height);
-            
-            create_buffer();
-
-			const int OFFSET_RED   = 2;
-			const int OFFSET_GREEN = 1;
-			const int OFFSET_BLUE  = 0;
-			const int OFFSET_ALPHA = 3;
-            
-            for (int x = 0; x < width; x++)
-            {
-                for (int y = 0; y < height; y++)
-                {
-					int offset = (x + y * width) * 4;
-
-                    shm_data[offset + OFFSET_RED  ] = (x / (float)width ) * 256;
-                    shm_data[offset + OFFSET_GREEN] = (y / (float)height) * 256;
-                    shm_data[offset + OFFSET_BLUE ] = 0x00;
-                    shm_data[offset + OFFSET_ALPHA] = 0xFF; //rand() % 256;
-                }
-            }
-
-            wl_surface_attach(surface_wl, shm_buffer, x, y);
-            wl_surface_damage(surface_wl, 0, 0, width, height);
-            wl_surface_commit(surface_wl);
-            
-            resized = false;
-        }
+		// Only draw once the compositor has asked for the next frame, so we
+		// never render more frames than the output refreshes
+		if ((resized || redraw) && frame_cb == nullptr)
+		{
+			if (resized)
+			{
+				LOG(Info, "Current Size: {},{}", width, height);
+
+				create_buffer();
+				damage.Add(Rect{ 0, 0, width, height });
+
+				resized = false;
+				redraw  = true ;
+			}
+
+			// nullptr while every buffer is still held by the compositor, its
+			// release wakes the dispatch below and we try again
+			Buffer* buffer = swapchain.Acquire();
+			if (buffer != nullptr)
+			{
+				// The buffer may be a few frames old, so it needs everything
+				// that changed since it was last drawn, not just this frame
+				swapchain.Damage(damage);
+				buffer->damage.Clip(Rect{ 0, 0, width, height });
+
+				// Formats other than (A|X)RGB8888 are drawn into the canvas and
+				// converted band by band, while the rows are still in cache
+				bool      convert       = Convert::Needed(format);
+				uint32_t* target        = convert ? canvas.data() : (uint32_t*)buffer->data;
+				int       target_stride = convert ? width * 4     : buffer->stride;
+
+				// Only formats with alpha can be translucent, and only the rows
+				// just drawn need checking while they are still in cache
+				bool              detect      = opaque_auto && Convert::HasAlpha(format);
+				std::atomic<bool> translucent = false;
+				bool              full        = false;
+
+				// The fill covers whole rows, so rectangles sharing rows are
+				// merged into disjoint bands first, each row drawn only once
+				Rect bands[Region::MaxRects];
+				int  count = 0;
+
+				for (const Rect& rect : buffer->damage)
+					bands[count++] = Rect{ 0, rect.y, width, rect.height };
+
+				std::sort(bands, bands + count, [](const Rect& a, const Rect& b) { return a.y < b.y; });
+
+				int merged = 0;
+				for (int a = 0; a < count; a++)
+				{
+					if (merged > 0 && bands[a].y <= bands[merged - 1].y + bands[merged - 1].height)
+						bands[merged - 1].height = std::max(bands[merged - 1].height, bands[a].y + bands[a].height - bands[merged - 1].y);
+					else
+						bands[merged++] = bands[a];
+				}
+
+				// Red grows to the right, green grows downwards. Only the rows
+				// under the damaged rectangles are drawn.
+				for (int a = 0; a < merged; a++)
+				{
+					const Rect& rect = bands[a];
+
+					workers.Run(rect.height, [&](int first, int last)
+					{
+						Fill::Bilinear(target, width, height, target_stride, 0xFF000000, 0xFFFF0000, 0xFF00FF00, 0xFFFFFF00, rect.y + first, rect.y + last);
+
+						if (detect && !Fill::Opaque(target, width, height, target_stride, rect.y + first, rect.y + last))
+							translucent = true;
+
+						if (convert)
+							Convert::Rows(canvas.data(), width * 4, buffer->data, buffer->stride, width, rect.y + first, rect.y + last, format);
+					});
+
+					full |= rect.y == 0 && rect.height == height;
+				}
+
+				// Rows that were not redrawn keep whatever they were, so a
+				// translucent frame only turns opaque once it is fully redrawn
+				if (detect)
+					content_opaque = !translucent && (content_opaque || full);
+
+				buffer->damage.Clear();
+
+				frame_cb = wl_surface_frame(surface_wl);
+				wl_callback_add_listener(frame_cb, &Listeners::wl_callback_frame, this);
+
+				wl_surface_attach(surface_wl, buffer->buffer, x, y);
+
+				// The compositor only needs to upload what changed since the last commit
+				damage.Clip(Rect{ 0, 0, width, height });
+				for (const Rect& rect : damage)
+				{
+					if (wl_surface_get_version(surface_wl) >= WL_SURFACE_DAMAGE_BUFFER_SINCE_VERSION)
+						wl_surface_damage_buffer(surface_wl, rect.x, rect.y, rect.width, rect.height);
+					else
+						wl_surface_damage(surface_wl, rect.x, rect.y, rect.width, rect.height);
+				}
+
+				update_opaque_region();
+				wl_surface_commit(surface_wl);
+
+				buffer->busy = true ;
+				redraw       = false;
+				damage.Clear();
+			}
+		}
+
+		// Sleeps until the compositor or another fd on the loop wakes us, frame callbacks included
+		if (!event_loop.Dispatch(timeout))
+			isOpen = false;
+	}
+
+	void Window::Redraw()
+	{
+		AddDamage(0, 0, width, height);
+	}
+
+	void Window::AddDamage(int x, int y, int width, int height)
+	{
+		damage.Add(Rect{ x, y, width, height });
+		redraw = true;
+	}
+
+	EventLoop& Window::GetEventLoop()
+	{
+		return event_loop;
 	}
 
 	bool Window::IsOpen()
@@ -500,6 +628,11 @@ namespace Wayland
 
 	}
 
+	void Window::SetThreads(int threads)
+	{
+		workers.Init(threads);
+	}
+
 	void Window::Show(bool show)
 	{
 
@@ -515,31 +648,62 @@ namespace Wayland
 		return false;
 	}
 
-	void Window::create_buffer() 
+	void Window::SetFormatHint(FormatHint hint)
 	{
-        if (pool)
-        {
-            wl_shm_pool_destroy(pool);
-            close(fd);
-        }
-        
-		int stride = width * 4; // 4 bytes per pixel
-		int size = stride * height;
-
-		fd = os_create_anonymous_file(size);
-		if (fd < 0) {
-			fprintf(stderr, "creating a buffer file for %d B failed: %m\n", size);
-			exit(1);
-		}
-	
-		shm_data = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-		if (shm_data == MAP_FAILED) {
-			fprintf(stderr, "mmap failed: %m\n");
-			close(fd);
-			exit(1);
+		format_hint = hint;
+		resized     = true;
+	}
+
+	void Window::SetOpaqueRegion(const Region& region)
+	{
+		opaque_auto   = false ;
+		opaque_region = region;
+		redraw        = true  ;
+	}
+
+	void Window::SetOpaqueAuto()
+	{
+		opaque_auto = true;
+		redraw      = true;
+	}
+
+	void Window::update_opaque_region()
+	{
+		Rect   bounds{ 0, 0, width, height };
+		Region opaque;
+
+		if (!opaque_auto)
+		{
+			opaque = opaque_region;
+			opaque.Clip(bounds);
 		}
+		else if (!Convert::HasAlpha(format) || content_opaque)
+			opaque.Add(bounds);
+
+		// The opaque region is double buffered state, only send it when it changes
+		if (opaque == opaque_sent)
+			return;
+
+		wl_region* region = wl_compositor_create_region(compositor);
+		for (const Rect& rect : opaque)
+			wl_region_add(region, rect.x, rect.y, rect.width, rect.height);
+
+		wl_surface_set_opaque_region(surface_wl, region);
+		wl_region_destroy(region);
+
+		opaque_sent = opaque;
+	}
+
+	void Window::create_buffer() 
+	{
+		format = choose_format(format_hint);
+
+		if (Convert::Needed(format))
+			canvas.resize((size_t)width * height);
+		else
+			std::vector<uint32_t>().swap(canvas);
 
-		pool = wl_shm_create_pool(shm, fd, size);
-		shm_buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+		swapchain.SetFormat(format);
+		swapchain.Resize(width, height);
 	}
 }
@@ -6,7 +6,12 @@
 #include <xdg-shell-client-protocol.h>
 #include <xdg-decoration-client-protocol.h>
 
+#include "Swapchain.h"
+#include "EventLoop.h"
+#include "Workers.h"
+
 #include <string>
+#include <vector>
 
 namespace Wayland
 {
@@ -46,12 +51,26 @@ namespace Wayland
 			void Close(void*, xdg_toplevel*);
 		}
 
+		namespace WL_Callback
+		{
+			void Frame_Done(void*, wl_callback*, uint32_t);
+		}
+
 		namespace ZXDG_Toplevel_Decoration_V1
 		{
 			void Configure(void*, zxdg_toplevel_decoration_v1*, uint32_t);
 		}
 	}
-			
+
+	// What a window's content needs from its wl_shm format
+	enum class FormatHint
+	{
+		Translucent  , // ARGB8888
+		Opaque       , // XRGB8888, the compositor can skip blending
+		LowBandwidth , // RGB565 when advertised, half the bytes per pixel
+		HighPrecision, // XRGB2101010 when advertised
+	};
+
 	class Window
 	{
 		wl_surface                 * surface_wl         ;
@@ -65,19 +84,27 @@ namespace Wayland
 		wl_buffer                  * cursor_buffer      ;
 		wl_surface                 * cursor_surface     ;
 		zxdg_toplevel_decoration_v1* toplevel_decoration;
-		wl_buffer                  * shm_buffer         ;
+
+		Swapchain swapchain;
+		Workers   workers  ;
+		Region    damage   ; // changed since the last commit
+
+		FormatHint            format_hint = FormatHint::Translucent;
+		uint32_t              format      = WL_SHM_FORMAT_ARGB8888 ;
+		std::vector<uint32_t> canvas                               ; // ARGB8888, only when format needs converting
+
+		bool   opaque_auto    = true ; // derive the opaque region from what is drawn
+		bool   content_opaque = false; // every pixel of the last frame had an alpha of 0xFF
+		Region opaque_region         ; // set by SetOpaqueRegion
+		Region opaque_sent           ; // last region given to the compositor
 
 		bool  isOpen  = false;
         bool  resized = true ;
+		bool  redraw  = true ;
 		int   x              ;
 		int   y              ;
 		int   width          ;
 		int   height         ;
-		char* shm_data       ;
-        
-        
-		int fd;
-		wl_shm_pool *pool;
 
 	public:
 		friend void Functions::WL_Registry::Global(void*, wl_registry*, uint32_t, const char*, uint32_t);
@@ -90,10 +117,13 @@ namespace Wayland
 		friend void Functions::XDG_Toplevel::Configure(void*, xdg_toplevel*, int32_t, int32_t, wl_array*);
 		friend void Functions::XDG_Toplevel::Close(void*, xdg_toplevel*);
 		friend void Functions::ZXDG_Toplevel_Decoration_V1::Configure(void*, zxdg_toplevel_decoration_v1*, uint32_t);
+		friend void Functions::WL_Callback::Frame_Done(void*, wl_callback*, uint32_t);
 
 		void Init(int width, int height, int x, int y, bool show = true, Window* parent = nullptr, bool noDecoration = false, bool noTaskbarIcon = false, bool topmost = false);
 
-		void  Poll				(						);
+		void  Poll				(int timeout = -1		); // milliseconds, -1 waits until something happens
+		void  Redraw			(						); // draw again when the compositor next asks for a frame
+		void  AddDamage			(int x, int y, int width, int height); // redraw only this part of the window
 		void* GetWindowHandler	(						);
 		void  ChangeWindowText	(std::string text		);
 		bool  IsOpen			(						);
@@ -101,11 +131,19 @@ namespace Wayland
 		void  SetPosition		(int x, int y			);
 		void  SetFocus			(						);
 		void  SetAlpha			(float alpha			);
+		void  SetThreads		(int threads			); // rasterize frames on this many cores, 0 for all of them
+		void  SetFormatHint		(FormatHint hint		);
+		void  SetOpaqueRegion	(const Region& region	); // surface coordinates, stops automatic detection
+		void  SetOpaqueAuto		(						); // opaque whenever every pixel drawn is, the default
 		void  Show				(bool show				);
 		bool  IsFocus			(						);
 		bool  IsMinimized		(						);
 		
-		static void SetupStatics();
+		static void       SetupStatics();
+		static EventLoop& GetEventLoop(); // add sockets and timers here to wait on them alongside the display
 		void create_buffer();
+
+	private:
+		void update_opaque_region();
 	};
 }
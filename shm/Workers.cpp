@@ -0,0 +1,111 @@
+#include "Workers.h"
+
+#include <algorithm>
+
+namespace Wayland
+{
+	// Enough bands per thread to even out uneven rows, few enough that the
+	// counter is not contended
+	static const int BandsPerThread = 4;
+
+	Workers::~Workers()
+	{
+		Destroy();
+	}
+
+	void Workers::Init(int count)
+	{
+		Destroy();
+
+		if (count <= 0)
+			count = std::max(1u, std::thread::hardware_concurrency());
+
+		quit = false;
+		for (int a = 1; a < count; a++)
+			threads.emplace_back(&Workers::Work, this);
+	}
+
+	void Workers::Bands()
+	{
+		for (;;)
+		{
+			int first = next.fetch_add(band);
+			if (first >= rows)
+				return;
+
+			(*job)(first, std::min(first + band, rows));
+		}
+	}
+
+	void Workers::Work()
+	{
+		uint64_t seen = 0;
+
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				start.wait(lock, [&] { return quit || generation != seen; });
+
+				if (quit)
+					return;
+
+				seen = generation;
+			}
+
+			Bands();
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (--pending == 0)
+				done.notify_one();
+		}
+	}
+
+	void Workers::Run(int rows, const Job& job)
+	{
+		if (threads.empty())
+		{
+			job(0, rows);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			this->job  = &job;
+			this->rows = rows;
+			band       = std::max(1, rows / (Count() * BandsPerThread));
+			next       = 0;
+			pending    = threads.size();
+			generation++;
+		}
+		start.notify_all();
+
+		Bands();
+
+		// Every band is handed out, but the workers may still be drawing theirs
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [&] { return pending == 0; });
+
+		this->job = nullptr;
+	}
+
+	int Workers::Count()
+	{
+		return threads.size() + 1;
+	}
+
+	void Workers::Destroy()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		start.notify_all();
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		threads.clear();
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Wayland
+{
+	// A fixed set of threads that split the rows of a frame between them.
+	// Run hands out bands of rows from a shared counter, so faster threads
+	// take more bands, and returns once every row has been drawn. The calling
+	// thread takes bands too, so Init(1) runs everything inline.
+	class Workers
+	{
+	public:
+		using Job = std::function<void(int first, int last)>;
+
+	private:
+		std::vector<std::thread> threads;
+		std::mutex               mutex  ;
+		std::condition_variable  start  ;
+		std::condition_variable  done   ;
+
+		const Job*       job        = nullptr;
+		int              rows       = 0      ;
+		int              band       = 0      ;
+		std::atomic<int> next       { 0 }    ;
+		int              pending    = 0      ;
+		uint64_t         generation = 0      ;
+		bool             quit       = false  ;
+
+		void Work  (              );
+		void Bands (              );
+
+	public:
+		~Workers();
+
+		void Init   (int count = 0                 ); // 0 uses every core
+		void Run    (int rows, const Job& job      );
+		int  Count  (                              );
+		void Destroy(                              );
+	};
+}